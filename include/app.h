@@ -0,0 +1,52 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <GLFW/glfw3.h>
+
+#include "common.h"
+
+// Window, input and scene state of the app, the core library never sees these
+extern glm::ivec4 initial_window;
+extern glm::ivec4 current_window;
+extern bool fullscreen;
+extern bool headless;
+extern bool render_enabled;
+extern bool exit_requested;
+extern bool on_demand;
+extern bool debug_ui;
+extern bool model_interpolation;
+extern float mouseSensitivity;
+extern float preciseSpeed;
+extern float movementSpeed;
+extern float rapidSpeed;
+extern glm::mat4 viewport_inversion;
+extern GLFWwindow *window;
+extern GLuint default_framebuffer;
+extern GLint uni_projection;
+extern GLint uni_model;
+extern GLint uni_norm;
+extern GLint uni_view;
+extern vec3_d robot_target;
+
+void framebuffer_size_callback(GLFWwindow *window, int width, int height);
+void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
+void cursor_position_callback(GLFWwindow *window, double x, double y);
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
+void handle_keyboard(GLFWwindow* window, float deltaTime);
+void register_input();
+void joystick_callback(int jid, int event);
+void handle_signal(int sig);
+
+void handle_error(const char *str, int errcode = -1);
+void reset();
+void destroy();
+void hint_exit();
+bool should_exit();
+void request_redraw();
+bool key_down(int key);
+void safe_exit(int errcode = 0);
+void set_segments_from_robot();
+void set_segments_from_sliders();
+void set_sliders_from_segments();
+void set_robot_from_segments();
+void toggle_fullscreen_state();
\ No newline at end of file
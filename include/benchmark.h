@@ -0,0 +1,177 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <errno.h>
+
+#include "common.h"
+
+namespace gui {
+
+enum benchmark_phase_t {
+    BENCH_INPUT,
+    BENCH_IK,
+    BENCH_ROBOT,
+    BENCH_SEGMENTS,
+    BENCH_DEBUG,
+    BENCH_UI,
+    BENCH_SWAP,
+    BENCH_FRAME,
+    BENCH_PHASE_COUNT
+};
+
+enum benchmark_counter_t {
+    COUNT_TICKS,
+    COUNT_IK_SOLVES,
+    COUNT_SERVO_COMMANDS,
+    COUNT_COLLISIONS,
+    BENCH_COUNTER_COUNT
+};
+
+/*
+Fixed frame count benchmark of the main loop.
+Simulation time advances by a constant dt per frame so the scripted
+camera and servo sweep produce the same frames on every run, only the
+measured CPU time per phase varies. Warmup frames are run but not recorded.
+Counters total the work done over the recorded frames, they should match
+across builds for the same script or input recording.
+*/
+struct benchmark_t {
+    static constexpr const char *phase_names[BENCH_PHASE_COUNT] = {
+        "input", "ik", "robot", "segments", "debug", "ui", "swap", "frame"
+    };
+
+    static constexpr const char *counter_names[BENCH_COUNTER_COUNT] = {
+        "ticks", "ik_solves", "servo_commands", "collisions"
+    };
+
+    struct stats_t {
+        double min, mean, p95, p99, max;
+    };
+
+    benchmark_t(int frames, int warmup = 60, double dt = 1.0 / 60.0):
+    frames(frames),
+    warmup(warmup),
+    frame(0),
+    dt(dt),
+    current{0},
+    pending{0},
+    counters{0},
+    tp_frame(hrc::now()) {
+        for (auto &phase : samples)
+            phase.reserve(frames);
+    }
+
+    int frames, warmup, frame;
+    double dt;
+    double current[BENCH_PHASE_COUNT];
+    uint64_t pending[BENCH_COUNTER_COUNT], counters[BENCH_COUNTER_COUNT];
+    std::vector<double> samples[BENCH_PHASE_COUNT];
+    ::tp tp_frame;
+
+    // Times a phase until the end of the enclosing scope, no-op without a benchmark
+    struct scope_t {
+        scope_t(benchmark_t *bench, benchmark_phase_t phase):
+        bench(bench),
+        phase(phase) {
+            if (bench)
+                start = hrc::now();
+        }
+
+        ~scope_t() {
+            if (bench)
+                bench->current[phase] += ::dur(hrc::now() - start).count() * 1000.0;
+        }
+
+        benchmark_t *bench;
+        benchmark_phase_t phase;
+        ::tp start;
+    };
+
+    inline void count(benchmark_counter_t counter, uint64_t n = 1) {
+        pending[counter] += n;
+    }
+
+    inline double get_time() const {
+        return frame * dt;
+    }
+
+    inline bool is_done() const {
+        return frame >= warmup + frames;
+    }
+
+    // Call once per frame after the swap
+    void end_frame() {
+        auto now = hrc::now();
+        current[BENCH_FRAME] = ::dur(now - tp_frame).count() * 1000.0;
+        tp_frame = now;
+
+        if (frame >= warmup) {
+            for (int i = 0; i < BENCH_PHASE_COUNT; i++)
+                samples[i].push_back(current[i]);
+
+            for (int i = 0; i < BENCH_COUNTER_COUNT; i++)
+                counters[i] += pending[i];
+        }
+
+        for (auto &phase : current)
+            phase = 0;
+
+        for (auto &counter : pending)
+            counter = 0;
+
+        frame++;
+    }
+
+    stats_t get_stats(int phase) const {
+        std::vector<double> sorted = samples[phase];
+
+        if (sorted.size() < 1)
+            return {0};
+
+        std::sort(sorted.begin(), sorted.end());
+
+        auto percentile = [&](double p) {
+            size_t rank = std::ceil(p * sorted.size());
+            return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+        };
+
+        double sum = 0;
+        for (auto &sample : sorted)
+            sum += sample;
+
+        return {sorted.front(), sum / sorted.size(), percentile(0.95), percentile(0.99), sorted.back()};
+    }
+
+    bool write_json(const char *path, const char *renderer) const {
+        FILE *file = fopen(path, "w");
+
+        if (!file) {
+            fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+            return glfail;
+        }
+
+        fprintf(file, "{\n  \"frames\": %i,\n  \"warmup\": %i,\n  \"dt\": %f,\n  \"renderer\": \"%s\",\n  \"unit\": \"ms\",\n  \"phases\": {\n",
+            (int)samples[BENCH_FRAME].size(), warmup, dt, renderer ? renderer : "");
+
+        for (int i = 0; i < BENCH_PHASE_COUNT; i++) {
+            auto stats = get_stats(i);
+            fprintf(file, "    \"%s\": {\"min\": %.4f, \"mean\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+                phase_names[i], stats.min, stats.mean, stats.p95, stats.p99, stats.max,
+                i + 1 < BENCH_PHASE_COUNT ? "," : "");
+        }
+
+        fprintf(file, "  },\n  \"counters\": {\n");
+
+        for (int i = 0; i < BENCH_COUNTER_COUNT; i++)
+            fprintf(file, "    \"%s\": %lu%s\n", counter_names[i], (unsigned long)counters[i],
+                i + 1 < BENCH_COUNTER_COUNT ? "," : "");
+
+        fprintf(file, "  }\n}\n");
+        fclose(file);
+
+        return glsuccess;
+    }
+};
+
+}
\ No newline at end of file
@@ -2,7 +2,7 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
-#include "common.h"
+#include "app.h"
 
 struct camera_t;
 
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <assert.h>
+
+#include "sim_clock.h"
+
+// Servo calibration and state of one joint, by value
+template<typename SERVO_T = int, typename T = float>
+struct servo_fields_T {
+    using dur_type = long;
+    using clk = sim_clock_t;
+    using tp = std::chrono::time_point<clk>;
+
+    SERVO_T servo_cur_position, servo_end_position;
+    SERVO_T servo_min, servo_max, servo_home;
+    int servo_num;
+
+    T degrees_per_second, steps_per_degree;
+    tp last_command;
+
+    dur_type min_command_interval = 20;
+    SERVO_T min_command_threshold = 1;
+};
+
+/*
+Joint state of a whole chain, one contiguous array per field.
+Arrays are aligned and sized in whole SIMD widths, padding lanes hold
+harmless values, so loops over padded() vectorize without a scalar tail.
+Segments are views into one slot, the arrays must not move once bound.
+*/
+template<typename SERVO_T = int, typename T = float>
+struct chain_state_T {
+    using fields_type = servo_fields_T<SERVO_T, T>;
+    using dur_type = typename fields_type::dur_type;
+    using tp = typename fields_type::tp;
+
+    static constexpr int lanes = 8;
+    static constexpr int capacity = 32;
+
+    static_assert(capacity % lanes == 0, "Capacity must be whole lanes");
+
+    int count;
+
+    alignas(32) SERVO_T servo_cur_position[capacity];
+    alignas(32) SERVO_T servo_end_position[capacity];
+    alignas(32) SERVO_T servo_min[capacity];
+    alignas(32) SERVO_T servo_max[capacity];
+    alignas(32) SERVO_T servo_home[capacity];
+    alignas(32) SERVO_T min_command_threshold[capacity];
+    alignas(32) int servo_num[capacity];
+    alignas(32) T degrees_per_second[capacity];
+    alignas(32) T steps_per_degree[capacity];
+    alignas(32) tp last_command[capacity];
+    alignas(32) dur_type min_command_interval[capacity];
+
+    chain_state_T() {
+        clear();
+    }
+
+    chain_state_T(const chain_state_T &) = delete;
+
+    chain_state_T &operator=(const chain_state_T &) = delete;
+
+    void clear() {
+        count = 0;
+
+        for (int i = 0; i < capacity; i++)
+            set(i, fields_type{0, 0, 0, 0, 0, 0, T(0), T(1)});
+    }
+
+    inline int padded() const {
+        return (count + lanes - 1) / lanes * lanes;
+    }
+
+    void set(int i, const fields_type &fields) {
+        servo_cur_position[i] = fields.servo_cur_position;
+        servo_end_position[i] = fields.servo_end_position;
+        servo_min[i] = fields.servo_min;
+        servo_max[i] = fields.servo_max;
+        servo_home[i] = fields.servo_home;
+        min_command_threshold[i] = fields.min_command_threshold;
+        servo_num[i] = fields.servo_num;
+        degrees_per_second[i] = fields.degrees_per_second;
+        steps_per_degree[i] = fields.steps_per_degree;
+        last_command[i] = fields.last_command;
+        min_command_interval[i] = fields.min_command_interval;
+    }
+
+    // Slot for a new joint, -1 when full
+    int add(const fields_type &fields) {
+        if (count >= capacity)
+            return -1;
+
+        set(count, fields);
+
+        return count++;
+    }
+};
+
+using chain_state_t = chain_state_T<int, float>;
\ No newline at end of file
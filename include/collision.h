@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+struct mesh_t;
+
+struct collision_aabb_t {
+    glm::vec3 min, max;
+
+    inline bool overlaps(const collision_aabb_t &other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    inline void grow(const glm::vec3 &point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    // Bounds of this box after an affine transform
+    collision_aabb_t transformed(const glm::mat4 &transform) const;
+
+    static collision_aabb_t empty();
+};
+
+struct collision_triangle_t {
+    glm::vec3 v[3];
+};
+
+/*
+Bounding volume hierarchy over one mesh's triangles, in mesh space.
+Built by median splits on the longest axis, nodes are stored depth first
+so a node's left child directly follows it and right points past the
+left subtree. Triangles are reordered so every leaf owns a range.
+*/
+struct collision_bvh_t {
+    static constexpr int leaf_size = 4;
+
+    struct node_t {
+        collision_aabb_t box;
+        uint32_t first, count, right;
+
+        inline bool leaf() const {
+            return count > 0;
+        }
+    };
+
+    std::vector<node_t> nodes;
+    std::vector<collision_triangle_t> triangles;
+
+    void build(const mesh_t &mesh);
+
+    void build(std::vector<collision_triangle_t> &&triangles);
+
+    inline bool empty() const {
+        return nodes.empty();
+    }
+
+private:
+    uint32_t build_node(uint32_t first, uint32_t count, std::vector<glm::vec3> &centroids);
+};
+
+/*
+Static scene around an arm, y up: an optional floor plane and axis
+aligned boxes. Descriptions give it in model units relative to the root
+joint, checks take it in world units.
+*/
+struct collision_scene_t {
+    bool has_floor = false;
+    float floor_height = 0.0f;
+    std::vector<collision_aabb_t> boxes;
+};
+
+// What a check hit, b is another body, FLOOR, or BOX minus the box index
+struct collision_contact_t {
+    static constexpr int FLOOR = -1;
+    static constexpr int BOX = -2;
+
+    int a, b;
+};
+
+/*
+Posed bodies checked against each other and a scene. The broadphase
+compares world bounds of whole bodies, the narrowphase descends both
+BVHs in one body's mesh space and separating axis tests the triangles.
+Bodies next to each other in the chain touch at their joint by design
+and are never tested against each other. Bodies flagged fixed do not
+move relative to the scene and skip it.
+*/
+struct collision_checker_t {
+    struct body_t {
+        const collision_bvh_t *bvh;
+        glm::mat4 transform;
+        collision_aabb_t bounds;
+        int parent;
+        bool fixed;
+    };
+
+    std::vector<body_t> bodies;
+
+    void clear();
+
+    // Parent is a previous body's index or -1
+    void add(const collision_bvh_t *bvh, const glm::mat4 &transform, int parent, bool fixed = false);
+
+    // First contact found, false when clear
+    bool check(const collision_scene_t &scene, collision_contact_t *contact = nullptr) const;
+
+    bool bodies_collide(const body_t &a, const body_t &b) const;
+
+    bool body_hits_box(const body_t &body, const collision_aabb_t &box) const;
+
+    bool body_below(const body_t &body, const float &height) const;
+};
+
+namespace collision {
+    // Separating axis tests, true when the shapes overlap
+    bool triangles_overlap(const glm::vec3 *a, const glm::vec3 *b);
+
+    bool triangle_box_overlap(const glm::vec3 *triangle, const collision_aabb_t &box);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common.h"
+#include "camera.h"
+#include "shader_program.h"
+
+struct debug_vertex_t {
+    glm::vec3 position;
+    glm::vec4 color;
+};
+
+/*
+Lines, points and axes collected over a frame and streamed into one
+orphaned vertex buffer. Lines and point billboards are drawn with one
+call each. The vectors keep their capacity between frames.
+*/
+struct debug_draw_t {
+    struct point_t {
+        glm::vec3 position;
+        float radius;
+        glm::vec4 color;
+    };
+
+    std::vector<debug_vertex_t> lines, triangles;
+    std::vector<point_t> points;
+    shader_program_t *program;
+    GLuint vao, vbo, capacity;
+
+    glm::vec4 line_color = {0,0,0,1};
+    glm::vec4 point_color = {1,0,0,1};
+    float point_scale = 5.0f;
+
+    debug_draw_t(shader_program_t *program);
+
+    ~debug_draw_t();
+
+    void add_line(const glm::vec3 &origin, const glm::vec3 &end, const glm::vec4 &color);
+
+    inline void add_line(const glm::vec3 &origin, const glm::vec3 &end) {
+        add_line(origin, end, line_color);
+    }
+
+    void add_point(const glm::vec3 &origin, const float &radius, const glm::vec4 &color);
+
+    inline void add_sphere(const glm::vec3 &origin, const float &radius) {
+        add_point(origin, radius, point_color);
+    }
+
+    // Columns 0-2 of the matrix as red, green and blue lines
+    void add_axes(const glm::vec3 &origin, const glm::mat4 &mat, const float &length = 1.0f);
+
+    void clear();
+
+    void render(camera_t *camera);
+
+    protected:
+    void upload();
+};
\ No newline at end of file
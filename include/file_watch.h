@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include "app.h"
+
+/*
+Watches files through inotify on their parent directories.
+Editors often replace files by renaming, so whole directories are watched
+and events are matched back to the registered paths by name.
+*/
+struct file_watch_t {
+    using callback_t = std::function<bool(const std::string &path)>;
+
+    int fd;
+    std::map<int, std::string> directories;
+    std::map<std::string, std::vector<callback_t>> callbacks;
+
+    file_watch_t();
+
+    ~file_watch_t();
+
+    inline constexpr bool isLoaded() const {
+        return fd > -1;
+    }
+
+    bool add_directory(const std::string &directory);
+
+    // callback returns glsuccess on reload, glfail to keep the previous resource
+    bool watch(const std::string &path, callback_t callback);
+
+    // Call once per frame, never blocks
+    void update();
+};
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <vector>
+#include <iterator>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+enum fixed_axis_t {
+    FIXED_AXIS_X,
+    FIXED_AXIS_Y,
+    FIXED_AXIS_Z
+};
+
+// One joint of a fixed chain, lengths and offsets in model units
+struct fixed_joint_t {
+    fixed_axis_t axis;
+    float length;
+    float offset[3];
+};
+
+/*
+Kinematic chain with the topology fixed at compile time. TOPOLOGY
+provides model_scale and a constexpr joints array, root first, matching
+what segment_T computes at runtime: the root is turned -90 degrees about
+x, every other joint turns its parent's frame about its own axis and
+starts at the parent's tip plus its offset in the parent's frame.
+
+Each joint is expanded on its own, rotations about a frame axis become a
+sin/cos pair applied to two columns, zero offsets drop out entirely, so
+forward kinematics and the Jacobian compile to straight line code.
+Angles are in degrees like segment_T, the root's angle is ignored.
+*/
+template<typename TOPOLOGY>
+struct fixed_chain_T {
+    static constexpr int joint_count = std::size(TOPOLOGY::joints);
+    static constexpr float model_scale = TOPOLOGY::model_scale;
+
+    static_assert(joint_count > 1, "Chain needs a root and a joint");
+
+    struct pose_t {
+        glm::vec3 origins[joint_count];
+        // World rotation axis of each joint, the root's is unused
+        glm::vec3 axes[joint_count];
+        glm::vec3 tip;
+    };
+
+    // Tip velocity per radian of each joint, the root's column is zero
+    using jacobian_t = glm::vec3[joint_count];
+
+    template<int I>
+    static inline constexpr glm::vec3 offset() {
+        constexpr auto &o = TOPOLOGY::joints[I].offset;
+        return glm::vec3(o[0], o[1], o[2]) * model_scale;
+    }
+
+    template<int I>
+    static inline constexpr bool has_offset() {
+        constexpr auto &o = TOPOLOGY::joints[I].offset;
+        return o[0] != 0.0f || o[1] != 0.0f || o[2] != 0.0f;
+    }
+
+    // frame * rotate(degrees, axis), only the two columns the axis mixes change
+    template<fixed_axis_t AXIS>
+    static inline void rotate(glm::mat3 &frame, const float &degrees) {
+        const float r = glm::radians(degrees);
+        const float s = std::sin(r), c = std::cos(r);
+
+        constexpr int a = AXIS == FIXED_AXIS_X ? 1 : AXIS == FIXED_AXIS_Y ? 2 : 0;
+        constexpr int b = AXIS == FIXED_AXIS_X ? 2 : AXIS == FIXED_AXIS_Y ? 0 : 1;
+
+        const glm::vec3 col_a = frame[a], col_b = frame[b];
+        frame[a] = c * col_a + s * col_b;
+        frame[b] = c * col_b - s * col_a;
+    }
+
+    template<int I>
+    static inline void forward_joint(const float *degrees, glm::mat3 &frame, glm::vec3 &end, pose_t &pose) {
+        constexpr fixed_joint_t joint = TOPOLOGY::joints[I];
+        constexpr float length = joint.length * model_scale;
+
+        if constexpr (has_offset<I>())
+            end += frame * offset<I>();
+
+        pose.origins[I] = end;
+        pose.axes[I] = frame[joint.axis];
+
+        rotate<joint.axis>(frame, degrees[I]);
+
+        end += frame[2] * length;
+
+        if constexpr (I + 1 < joint_count)
+            forward_joint<I + 1>(degrees, frame, end, pose);
+    }
+
+    // root is the root joint's origin, as segment_T::get_origin gives it
+    static inline void forward(const glm::vec3 &root, const float *degrees, pose_t &pose) {
+        constexpr float length = TOPOLOGY::joints[0].length * model_scale;
+
+        // rotate(-90 degrees, x)
+        glm::mat3 frame(glm::vec3(1, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+        glm::vec3 end = root + frame[2] * length;
+
+        pose.origins[0] = root;
+        pose.axes[0] = glm::vec3(0.0f);
+
+        forward_joint<1>(degrees, frame, end, pose);
+
+        pose.tip = end;
+    }
+
+    template<int I>
+    static inline void jacobian_joint(const pose_t &pose, jacobian_t &jacobian) {
+        jacobian[I] = glm::cross(pose.axes[I], pose.tip - pose.origins[I]);
+
+        if constexpr (I + 1 < joint_count)
+            jacobian_joint<I + 1>(pose, jacobian);
+    }
+
+    static inline void jacobian(const pose_t &pose, jacobian_t &jacobian) {
+        jacobian[0] = glm::vec3(0.0f);
+        jacobian_joint<1>(pose, jacobian);
+    }
+
+    // Whether a runtime chain has exactly this topology
+    template<typename SEGMENT>
+    static bool matches(const std::vector<SEGMENT*> &chain) {
+        if (chain.size() != joint_count)
+            return false;
+
+        for (int i = 0; i < joint_count; i++) {
+            const auto &joint = TOPOLOGY::joints[i];
+            const auto *segment = chain[i];
+
+            glm::vec3 axis(0.0f);
+            axis[joint.axis] = 1.0f;
+
+            if (segment->model_scale != model_scale || segment->length != joint.length)
+                return false;
+
+            // Each joint hangs directly off the previous one, nothing in between moves it
+            if (i > 0 && segment->parent != chain[i - 1])
+                return false;
+
+            // The root's offset places the arm, it is part of the input origin
+            if (i > 0 && (segment->rotation_axis != axis ||
+                segment->offset != glm::vec3(joint.offset[0], joint.offset[1], joint.offset[2])))
+                return false;
+        }
+
+        return true;
+    }
+
+    // Pose of a matching runtime chain at its current angles
+    template<typename SEGMENT>
+    static inline void forward(const std::vector<SEGMENT*> &chain, const bool &allow_interpolate, pose_t &pose) {
+        float degrees[joint_count];
+
+        for (int i = 0; i < joint_count; i++)
+            degrees[i] = chain[i]->get_rotation(allow_interpolate);
+
+        forward(chain[0]->get_origin(allow_interpolate), degrees, pose);
+    }
+};
+
+// Must match the IK joints of assets/xarm.robot, matches() checks a loaded chain
+struct xarm_topology_t {
+    static constexpr float model_scale = 0.1f;
+    static constexpr fixed_joint_t joints[] = {
+        {FIXED_AXIS_Z, 46.19f, {0.0f, 0.0f, 0.0f}},
+        {FIXED_AXIS_Z, 35.98f, {0.0f, 0.0f, 0.0f}},
+        {FIXED_AXIS_Y, 100.0f, {-2.54f, 0.0f, 0.0f}},
+        {FIXED_AXIS_Y, 96.0f, {0.0f, 0.0f, 0.0f}},
+        {FIXED_AXIS_Y, 150.0f, {0.0f, 0.0f, 0.0f}},
+    };
+};
+
+using xarm_chain_t = fixed_chain_T<xarm_topology_t>;
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "common.h"
+
+enum gpu_pass_t {
+    GPU_PASS_SEGMENTS,
+    GPU_PASS_DEBUG,
+    GPU_PASS_UI,
+    GPU_PASS_COUNT
+};
+
+/*
+GPU time per render pass through GL_TIME_ELAPSED queries.
+Each pass has one query per buffered frame, results are read a frame
+later and only once available, so reading never waits on the GPU.
+Without timer query support every call is a no-op.
+*/
+struct gpu_timer_t {
+    static constexpr int latency = 2;
+    static constexpr const char *pass_names[GPU_PASS_COUNT] = {
+        "seg", "debug", "ui"
+    };
+
+    struct scope_t {
+        scope_t(gpu_timer_t *timer, gpu_pass_t pass):
+        timer(timer) {
+            if (timer)
+                timer->begin(pass);
+        }
+
+        ~scope_t() {
+            if (timer)
+                timer->end();
+        }
+
+        gpu_timer_t *timer;
+    };
+
+    GLuint queries[latency][GPU_PASS_COUNT];
+    bool pending[latency][GPU_PASS_COUNT];
+    double results[GPU_PASS_COUNT];
+    int frame, active;
+    bool supported;
+
+    gpu_timer_t();
+
+    ~gpu_timer_t();
+
+    bool init();
+
+    // Passes cannot nest, TIME_ELAPSED queries are exclusive
+    void begin(gpu_pass_t pass);
+
+    void end();
+
+    // Call once per frame after the last pass
+    void end_frame();
+
+    void debug_info(char *buffer, const size_t &size, size_t &offset);
+};
\ No newline at end of file
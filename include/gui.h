@@ -9,6 +9,9 @@
 #include <algorithm>
 #include <map>
 #include <vector>
+#include <array>
+#include <bitset>
+#include <atomic>
 
 extern int errno;
 
@@ -91,22 +94,30 @@ namespace events {
     template<typename T>
     using GetEnum = Invoke<EnumType, T>;
 
+    // Indexed by event value, events are small contiguous enums
     template<typename Event, typename Function = GetFunction<Event>>
-    using GetMap = std::map<GetEnum<Event>, std::vector<Function>>;
+    using GetTable = std::vector<std::vector<Function>>;
 
     template<typename Event, typename Function = GetFunction<Event>>
     struct Dispatcher {
         using function = Function;
         using event = Event;
 
-        static GetMap<Event, Function> subscribers;
+        static GetTable<Event, Function> subscribers;
 
         template<typename ...Args>
         static void post(const Event &e, Args &&... args) {
-            gui::for_each<Function>(subscribers[e], args...);
+            if (size_t(e) >= subscribers.size())
+                return;
+
+            for (auto &func : subscribers[e])
+                func(args...);
         }
 
         static void subscribe(const Event &e, Function f) {
+            if (size_t(e) >= subscribers.size())
+                subscribers.resize(size_t(e) + 1);
+
             subscribers[e].push_back(f);
         }
     };
@@ -115,7 +126,219 @@ namespace events {
     using GetDispatcher = gui::events::Dispatcher<GetEnum<Event>, Function>;
 
     template<typename Event, typename Function>
-    GetMap<Event, Function> Dispatcher<Event, Function>::subscribers = GetMap<Event, Function>();
+    GetTable<Event, Function> Dispatcher<Event, Function>::subscribers = GetTable<Event, Function>();
+
+    enum InputEvents : event_t {
+        KEY,
+        MOUSE_BUTTON,
+        CURSOR,
+        FRAMEBUFFER,
+        JOYSTICK,
+        INPUT_EVENT_COUNT
+    };
+
+    // One record for every input source, action is a KeyboardEvents value for keys and buttons, x/y carry positions and sizes
+    struct InputEvent {
+        InputEvents type;
+        int code, action, mods;
+        double x, y;
+    };
+
+    // Fixed capacity FIFO, never allocates after construction
+    template<typename T, size_t N>
+    struct EventQueue {
+        std::array<T, N> events;
+        size_t count = 0;
+        size_t dropped = 0;
+
+        inline bool push(const T &e) {
+            if (count >= N) {
+                dropped++;
+                return false;
+            }
+
+            events[count++] = e;
+            return true;
+        }
+
+        inline T *back() {
+            return count > 0 ? &events[count - 1] : nullptr;
+        }
+
+        // Events pushed by handlers while draining are delivered in the same pass
+        template<typename Func>
+        inline void drain(Func func) {
+            for (size_t i = 0; i < count; i++)
+                func(events[i]);
+
+            count = 0;
+        }
+    };
+
+    /*
+    Bounded lock-free multi producer single consumer queue.
+    Dmitry Vyukov's array queue: each cell carries a sequence number telling
+    producers whether it is free and the consumer whether it is filled,
+    so producers only contend on one fetch position and never block.
+    A full queue rejects the event rather than waiting.
+    */
+    template<typename T, size_t N>
+    struct MPSCQueue {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "MPSCQueue size must be a power of two");
+
+        struct cell_t {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        alignas(64) cell_t cells[N];
+        alignas(64) std::atomic<size_t> enqueue_pos;
+        alignas(64) size_t dequeue_pos;
+        std::atomic<size_t> dropped;
+
+        MPSCQueue():
+        enqueue_pos(0),
+        dequeue_pos(0),
+        dropped(0) {
+            for (size_t i = 0; i < N; i++)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        // Any thread
+        bool push(const T &data) {
+            cell_t *cell;
+            size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+            while (true) {
+                cell = &cells[pos & (N - 1)];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+
+                if (difference == 0) {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else
+                if (difference < 0) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->data = data;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // Consumer thread only
+        bool pop(T &data) {
+            cell_t *cell = &cells[dequeue_pos & (N - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+
+            if ((intptr_t)sequence - (intptr_t)(dequeue_pos + 1) < 0)
+                return false;
+
+            data = cell->data;
+            cell->sequence.store(dequeue_pos + N, std::memory_order_release);
+            dequeue_pos++;
+
+            return true;
+        }
+
+        // Consumer thread only, at most limit events per call to bound latency
+        template<typename Func>
+        size_t drain(Func func, size_t limit = N) {
+            size_t count = 0;
+            T data;
+
+            while (count < limit && pop(data)) {
+                func(data);
+                count++;
+            }
+
+            return count;
+        }
+    };
+
+    /*
+    Main thread callbacks post here, other threads post_async, dispatch() runs once per frame on the main thread.
+    Handlers live in flat tables indexed by event type and key code,
+    keys currently down are kept in a bitset for continuous actions.
+    */
+    struct InputDispatcher {
+        using handler_t = void(*)(const InputEvent &e);
+
+        static constexpr int key_count = 512;
+
+        EventQueue<InputEvent, 256> queue;
+        MPSCQueue<InputEvent, 1024> remote;
+        std::bitset<key_count> keys;
+        std::vector<handler_t> handlers[INPUT_EVENT_COUNT];
+        handler_t press_handlers[key_count] = {0};
+        handler_t release_handlers[key_count] = {0};
+
+        inline void post(const InputEvent &e) {
+            // Only the latest cursor position matters
+            auto *last = queue.back();
+            if (e.type == CURSOR && last && last->type == CURSOR) {
+                *last = e;
+                return;
+            }
+
+            queue.push(e);
+        }
+
+        // Safe from any thread, delivered on the next dispatch
+        inline bool post_async(const InputEvent &e) {
+            return remote.push(e);
+        }
+
+        inline void subscribe(InputEvents type, handler_t handler) {
+            handlers[type].push_back(handler);
+        }
+
+        inline void on_press(int key, handler_t handler) {
+            if (key >= 0 && key < key_count)
+                press_handlers[key] = handler;
+        }
+
+        inline void on_release(int key, handler_t handler) {
+            if (key >= 0 && key < key_count)
+                release_handlers[key] = handler;
+        }
+
+        inline bool is_down(int key) const {
+            return key >= 0 && key < key_count && keys[key];
+        }
+
+        void dispatch() {
+            auto deliver = [this](const InputEvent &e) {
+                if (e.type == KEY && e.code >= 0 && e.code < key_count) {
+                    handler_t handler = nullptr;
+
+                    if (e.action == PRESS) {
+                        keys.set(e.code);
+                        handler = press_handlers[e.code];
+                    } else
+                    if (e.action == RELEASE) {
+                        keys.reset(e.code);
+                        handler = release_handlers[e.code];
+                    }
+
+                    if (handler)
+                        handler(e);
+                }
+
+                for (auto handler : handlers[e.type])
+                    handler(e);
+            };
+
+            remote.drain(deliver);
+            queue.drain(deliver);
+        }
+    };
 }
 
 template<typename Event, typename Function>
@@ -135,8 +358,8 @@ struct Element {
     virtual void destroy() = 0;
 };
 
-LogLevel logLevel = LogLevel::INFO;
-FILE *logFile = stderr;
+inline LogLevel logLevel = LogLevel::INFO;
+inline FILE *logFile = stderr;
 
 template<typename ...Args>
 int log(const char *format, Args &&... args) {
@@ -151,24 +374,24 @@ int log(LogLevel level, const char *format, Args &&... args) {
     return fprintf(logFile, format, std::forward<Args>(args)...);
 }
 
-int log(const char *format) { 
+inline int log(const char *format) { 
     return log("%s", format); 
 }
 
-int log(const std::string &str) {
+inline int log(const std::string &str) {
     return log("%s", str.c_str());
 }
 
-void safe_exit(int errcode = 0) {
+inline void safe_exit(int errcode = 0) {
     exit(errcode);
 }
 
-void fatal(const std::string &str, int errcode = -1) {
+inline void fatal(const std::string &str, int errcode = -1) {
     log("Error %s", str.c_str());
     safe_exit(errcode);
 }
 
-void fatal_errno(const std::string &str) {
+inline void fatal_errno(const std::string &str) {
     int _errno = errno;
     log("Error %s, %s %i", str.c_str(), strerror(_errno), _errno);
     safe_exit(_errno);
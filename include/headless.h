@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "app.h"
+
+/*
+Window-less OpenGL context through EGL for servers and CI.
+Prefers Mesa's surfaceless platform, falls back to the default display
+with a pbuffer. Rendering always goes into an offscreen framebuffer,
+which becomes default_framebuffer while the context is current.
+*/
+struct headless_context_t {
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+    GLuint fbo, color_rb, depth_rb;
+    glm::ivec2 size;
+    std::vector<unsigned char> pixels;
+    std::string dump_prefix;
+    int frame;
+
+    headless_context_t();
+
+    ~headless_context_t();
+
+    bool init(int width, int height);
+
+    void destroy();
+
+    // Binary PPM of the offscreen framebuffer
+    bool dump_frame(const char *path);
+
+    // Finishes the frame, dumps it when dump_prefix is set
+    void swap();
+};
\ No newline at end of file
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <algorithm>
+
+#include "fixed_chain.h"
+
+/*
+Small MLP approximating the xArm's inverse kinematics, trained on
+samples of its forward kinematics. Given the target relative to the root
+joint's origin and the pitch, the sum of the planar joint angles, it
+predicts the angle of every joint after the root. The pitch and keeping
+the elbow on one side make the inverse unique, the planar joints
+otherwise have a whole family of solutions for one target.
+
+Layers are fixed size, weights stored input major so every dense layer
+is bias, then one multiply add per input across a contiguous row of
+outputs, then the activation, all in one pass the compiler vectorizes.
+The activation is a clamped rational tanh, no transcendental calls.
+*/
+struct ik_network_t {
+    using chain_t = xarm_chain_t;
+
+    static constexpr int joints = chain_t::joint_count;
+    // x, y, z, pitch
+    static constexpr int inputs = 4;
+    // Every joint but the root
+    static constexpr int outputs = joints - 1;
+    static constexpr int width = 32;
+    // Output row padded to a whole vector
+    static constexpr int output_stride = 8;
+
+    static constexpr uint32_t magic = 0x4b49584e; // "NXIK"
+    static constexpr uint32_t version = 1;
+
+    static_assert(outputs <= output_stride, "Outputs do not fit the padded row");
+
+    // Everything training updates, walked as one flat array of floats
+    struct weights_t {
+        alignas(32) float w0[inputs][width];
+        alignas(32) float b0[width];
+        alignas(32) float w1[width][width];
+        alignas(32) float b1[width];
+        alignas(32) float w2[width][output_stride];
+        alignas(32) float b2[output_stride];
+
+        inline float *data() {
+            return reinterpret_cast<float*>(this);
+        }
+
+        inline const float *data() const {
+            return reinterpret_cast<const float*>(this);
+        }
+    };
+
+    static constexpr int weight_count = sizeof(weights_t) / sizeof(float);
+
+    // Hidden layer outputs, kept by training for the backward pass
+    struct activations_t {
+        alignas(32) float input[inputs];
+        alignas(32) float h1[width], h2[width];
+        alignas(32) float output[output_stride];
+    };
+
+    weights_t weights;
+    // Raw input minus offset times scale is what the network sees
+    float input_offset[inputs], input_scale[inputs];
+    // Network output times scale plus offset is degrees
+    float output_offset[outputs], output_scale[outputs];
+    // Range trained on, refinement keeps to it
+    float min_degrees[joints], max_degrees[joints];
+
+    ik_network_t();
+
+    static inline float activation(float x) {
+        x = std::min(std::max(x, -3.0f), 3.0f);
+        const float x2 = x * x;
+        return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+    }
+
+    // Derivative of activation at x, zero where it clamps
+    static inline float activation_slope(float x) {
+        x = std::min(std::max(x, -3.0f), 3.0f);
+        const float x2 = x * x;
+        const float d = 27.0f + 9.0f * x2;
+        return ((27.0f + 3.0f * x2) * d - 18.0f * x2 * (27.0f + x2)) / (d * d);
+    }
+
+    template<int IN, int OUT, bool ACTIVATE>
+    static inline void dense(const float (&w)[IN][OUT], const float (&b)[OUT], const float *in, float *out) {
+        alignas(32) float sum[OUT];
+
+        for (int o = 0; o < OUT; o++)
+            sum[o] = b[o];
+
+        for (int i = 0; i < IN; i++)
+            for (int o = 0; o < OUT; o++)
+                sum[o] += in[i] * w[i][o];
+
+        for (int o = 0; o < OUT; o++)
+            out[o] = ACTIVATE ? activation(sum[o]) : sum[o];
+    }
+
+    // Normalized input to normalized output, every layer's result kept
+    inline void forward(activations_t &a) const {
+        dense<inputs, width, true>(weights.w0, weights.b0, a.input, a.h1);
+        dense<width, width, true>(weights.w1, weights.b1, a.h1, a.h2);
+        dense<width, output_stride, false>(weights.w2, weights.b2, a.h2, a.output);
+    }
+
+    // Sum of the planar joint angles, the second network input
+    static inline float pitch(const float *degrees) {
+        float sum = 0.0f;
+
+        for (int i = 2; i < joints; i++)
+            sum += degrees[i];
+
+        return sum;
+    }
+
+    void normalize_input(const glm::vec3 &target, const float &pitch, float *input) const;
+
+    // Angles straight from the network, target relative to the root joint's origin
+    void predict(const glm::vec3 &target, const float &pitch, float *degrees) const;
+
+    // Prediction refined by damped least squares on the forward kinematics, returns the tip's distance from target
+    float solve(const glm::vec3 &root, const glm::vec3 &target, const float &pitch, float *degrees, int refine_steps = 3) const;
+
+    bool save(const char *path) const;
+
+    bool load(const char *path);
+};
+
+/*
+Forward kinematics samples, uniform over each joint's range with the
+elbow kept on one side. Inputs and outputs are raw, the network
+normalizes them with the offsets and scales training sets from them.
+*/
+struct ik_dataset_t {
+    static constexpr int inputs = ik_network_t::inputs;
+    static constexpr int outputs = ik_network_t::outputs;
+
+    std::vector<float> input, output;
+    float min_degrees[ik_network_t::joints], max_degrees[ik_network_t::joints];
+
+    inline int size() const {
+        return input.size() / inputs;
+    }
+
+    void generate(const float *min_degrees, const float *max_degrees, int count, uint32_t seed = 1);
+};
+
+// Minibatch Adam on mean squared error of the normalized outputs
+struct ik_trainer_t {
+    int epochs;
+    int batch_size;
+    float learning_rate;
+    // Learning rate multiplier reached by the last epoch
+    float final_rate;
+    uint32_t seed;
+    bool verbose;
+
+    ik_trainer_t();
+
+    // Initializes the network from the data and trains it, returns the last epoch's loss
+    float train(ik_network_t &network, const ik_dataset_t &data) const;
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "app.h"
+
+struct input_pad_t {
+    int32_t jid, axis_count, button_count;
+    float deadzones[GLFW_GAMEPAD_AXIS_LAST + 1];
+    GLFWgamepadstate state;
+};
+
+// Everything the simulation reads from devices during one tick
+struct input_tick_t {
+    static constexpr int key_words = 512 / 64;
+    static constexpr int pad_slots = GLFW_JOYSTICK_LAST + 1;
+    static constexpr int press_slots = 8;
+
+    double time;
+    uint64_t keys[key_words];
+    // Keys whose press runs a one-off action, replayed before the tick
+    uint32_t press_count;
+    int32_t presses[press_slots];
+    uint32_t pad_count;
+    input_pad_t pads[pad_slots];
+};
+
+/*
+Binary recording of the input consumed by the simulation.
+Each frame stores its delta time, each simulation tick stores the held
+keys, the action keys pressed since the last tick and the polled gamepad
+states. With the same tick rate, playback
+runs the same ticks in the same frames and feeds them the recorded
+state in place of live devices, so the simulation repeats exactly.
+*/
+struct input_record_t {
+    static constexpr uint32_t magic = 0x5249584e; // "NXIR"
+    static constexpr uint32_t version = 2;
+
+    struct header_t {
+        uint32_t magic, version;
+        double tick_rate;
+        uint64_t frames, ticks;
+    };
+
+    enum chunk_t : uint8_t {
+        CHUNK_FRAME = 'F',
+        CHUNK_TICK = 'T'
+    };
+
+    FILE *file;
+    header_t header;
+    bool playback;
+    uint64_t frame, tick;
+    uint32_t press_count;
+    int32_t presses[input_tick_t::press_slots];
+
+    input_record_t();
+
+    ~input_record_t();
+
+    bool open_record(const char *path, double tick_rate);
+
+    bool open_playback(const char *path);
+
+    // Record mode rewrites the header with the final counts
+    void close();
+
+    // Record stores delta_time, playback replaces it, false once the recording ends
+    bool begin_frame(double &delta_time);
+
+    // Record only, stored with the next tick
+    void press(int key);
+
+    // Record stores the tick, playback fills it, false when the frame has no more ticks
+    bool sync_tick(input_tick_t &tick);
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "robot_description.h"
+#include "trajectory.h"
+
+namespace gui {
+    struct benchmark_t;
+}
+
+struct ik_network_t;
+
+/*
+Inverse kinematics of one chain, a geometric solve of the base yaw then
+the planar joints, the network covering what it cannot reach. Solutions
+are set on the chain's servos only when the whole move to them is clear.
+Knows nothing of the window or the sliders, solved_callback tells the
+app a new solution was applied.
+*/
+struct kinematics_t {
+    using callback_t = std::function<void(kinematics_t*)>;
+
+    robot_chain_t *chain;
+    trajectory_validator_t validator;
+    // Optional, needs the chain's fixed_xarm topology
+    ik_network_t *network;
+    gui::benchmark_t *benchmark;
+    bool collision_checking;
+    callback_t solved_callback;
+
+    // Furthest a network solution's tip may end from the target, world units
+    static constexpr float network_tolerance = 1.0f;
+
+    // Validation threads as trajectory_validator_t takes them, one per core by default
+    kinematics_t(robot_chain_t *chain, int validate_threads = 0);
+
+    // Network seed refined on the fixed chain, keeping the arm's current pitch
+    bool solve_network(const vec3_d &target, std::vector<float> &rot_out);
+
+    bool solve_inverse(vec3_d coordsIn);
+};
\ No newline at end of file
@@ -30,6 +30,9 @@ struct mesh_t {
     */
     bool loadObj(const char *filepath);
 
+    // Replace the mesh in place, keeps the previous verticies on failure
+    bool reloadObj(const char *filepath);
+
     virtual void clear();
 
     virtual void mesh();
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "common.h"
+
+/*
+Scoped CPU zones for the hot paths.
+Each thread records finished zones into its own fixed ring, nothing is
+shared or allocated while recording. Build with -DPROFILE=ON to define
+NEURAL_XARM_PROFILE, otherwise PROFILE_SCOPE expands to nothing.
+*/
+#ifdef NEURAL_XARM_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) gui::profiler_t::scope_t PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+
+namespace gui {
+
+struct profile_zone_t {
+    const char *name;
+    uint64_t start, end;
+    uint32_t depth;
+};
+
+struct profile_thread_t {
+    static constexpr size_t capacity = 8192;
+
+    profile_zone_t zones[capacity];
+    // Total zones written, the ring holds the last capacity of them
+    std::atomic<uint64_t> count;
+    uint32_t depth;
+    uint32_t id;
+};
+
+struct profiler_t {
+#ifdef NEURAL_XARM_PROFILE
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    struct scope_t {
+        inline scope_t(const char *name):
+        thread(get_thread()),
+        name(name),
+        start(now()) {
+            thread.depth++;
+        }
+
+        inline ~scope_t() {
+            uint64_t index = thread.count.load(std::memory_order_relaxed);
+            thread.zones[index % profile_thread_t::capacity] = {name, start, now(), --thread.depth};
+            thread.count.store(index + 1, std::memory_order_release);
+        }
+
+        profile_thread_t &thread;
+        const char *name;
+        uint64_t start;
+    };
+
+    // Nanoseconds since the profiler epoch
+    static inline uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(hrc::now() - epoch).count();
+    }
+
+    static profile_thread_t &get_thread();
+
+    // Call once per frame on the main thread, nothing when disabled
+    static inline void frame() {
+        if constexpr (enabled) {
+            get_thread();
+
+            last_frame_start = frame_start;
+            frame_start = now();
+        }
+    }
+
+    // Indented timeline of the previous frame on the main thread, zones of equal name and depth merged
+    static void timeline(char *buffer, const size_t &size, size_t &offset, int width = 32);
+
+    static bool write_chrome_trace(const char *path);
+
+    static ::tp epoch;
+    static uint64_t frame_start, last_frame_start;
+    static std::mutex threads_lock;
+    static std::vector<profile_thread_t*> threads;
+};
+
+}
\ No newline at end of file
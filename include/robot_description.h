@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "common.h"
+#include "segment.h"
+#include "fixed_chain.h"
+#include "collision.h"
+
+struct mesh_t;
+
+struct joint_description_t {
+    std::string name, parent, mesh, role;
+    glm::vec3 axis, offset;
+    float length;
+    bool ik;
+    robot_servo_t servo;
+};
+
+/*
+Robot description file, one directive per line, # starts a comment.
+Joints are listed parent first, properties follow their joint line.
+
+    robot NAME
+    hid VENDOR PRODUCT
+    scale S
+    floor HEIGHT
+    box MIN_X MIN_Y MIN_Z MAX_X MAX_Y MAX_Z
+    joint NAME [PARENT]
+        axis x|y|z|X Y Z
+        length L
+        offset X Y Z
+        servo ID MIN MAX HOME DEGREES_PER_SECOND DEGREES_PER_STEP
+        mesh PATH
+        role NAME
+        ik
+
+Lengths and offsets are in model units, scaled by S. An offset shifts the
+joint from the parent's tip in the parent's frame, on the root it places
+the arm in the scene. The floor and boxes are obstacles for collision
+checks, in model units from the root joint's origin, y up. A negative degrees per
+step inverts the servo. The IK chain is the root, the base yaw joint,
+then the planar joints, in file order.
+*/
+struct robot_description_t {
+    std::string name, path;
+    unsigned short vendor_id, product_id;
+    float model_scale;
+    std::vector<joint_description_t> joints;
+    collision_scene_t scene;
+
+    robot_description_t();
+
+    bool load(const char *path);
+
+    int find(const std::string &joint) const;
+};
+
+/*
+Description compiled into one contiguous array of segments, parents
+before children, with views for drawing, servo control and IK.
+Servo state is kept per field in state, each segment is a view of its
+slot. Built once, neither moves so the views and parent pointers
+stay valid. Chains compiled from the same description can share meshes,
+the root joint's offset places each arm in the scene.
+*/
+struct robot_chain_t {
+    chain_state_t state;
+    std::vector<segment_t> segments;
+    std::vector<mesh_t*> meshes;
+    // One per mesh, built with it, visible[i] uses bvhs[i]
+    std::vector<collision_bvh_t*> bvhs;
+    std::vector<std::string> mesh_paths, roles;
+    std::vector<segment_t*> visible, servos, ik;
+    segment_t *tip;
+    collision_scene_t scene;
+    bool owns_meshes;
+    // IK joints have the xArm topology, xarm_chain_t computes their pose
+    bool fixed_xarm;
+
+    robot_chain_t();
+
+    ~robot_chain_t();
+
+    // Drops the segments and every view of them, and the meshes when owned
+    void clear();
+
+    // Starts from a cleared chain. Meshes of shared are reused when given, it must outlive this chain
+    bool compile(const robot_description_t &description, const robot_chain_t *shared = nullptr);
+
+    bool load_meshes();
+
+    // Rebuild one mesh's BVH after it changed
+    void build_bvh(int mesh);
+
+    // Model transforms of every segment at the given angles, without touching the servo state
+    void pose(const float *degrees, glm::mat4 *transforms) const;
+
+    // Posed visible segments against each other and the scene, true on contact
+    bool check_collision(const glm::mat4 *transforms, collision_contact_t *contact = nullptr) const;
+
+    bool check_collision(const bool &allow_interpolate = false, collision_contact_t *contact = nullptr) const;
+
+    segment_t *find_role(const std::string &role);
+
+    segment_t *find_servo(int servo_num) const;
+
+    // End of the last IK joint, where the IK target sits
+    glm::vec3 get_tip(const bool &allow_interpolate = true) const;
+};
\ No newline at end of file
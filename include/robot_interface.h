@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+#include <hidapi/hidapi.h>
+
+#include "gui.h"
+#include "robot_description.h"
+#include "robot_protocol.h"
+
+namespace gui {
+    struct benchmark_t;
+}
+
+/*
+HID connection to one arm driving its chain's servos. Commands are
+batched from the chain's state each update and queued to a control
+thread once the device is open, telemetry comes back through a queue
+and is applied on update. Without a device and permit_virtual the
+interface runs as a virtual robot, commands update the chain only.
+*/
+struct robot_interface_t {
+    using packet_t = robot_packet_t;
+    using telemetry_t = robot_telemetry_t;
+    using callback_t = std::function<void(robot_interface_t*)>;
+
+    hid_device *handle;
+    robot_chain_t *chain;
+    std::string serial_number;
+    bool servo_sleep_on_destroy = true;
+    bool virtual_output = false;
+    gui::benchmark_t *benchmark = nullptr;
+    // Positions read back were applied to the chain
+    callback_t telemetry_callback;
+
+    // Command scheduling state, per robot
+    segment_t::tp last_batch;
+    bool constant_speed = false;
+    int u_period = 10;
+    int m_period = 200;
+    int t_overlap = 0;
+
+    // Main thread produces packets and consumes telemetry, the control thread the reverse
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<uint32_t> wake;
+    gui::events::MPSCQueue<packet_t, 64> packets;
+    gui::events::MPSCQueue<telemetry_t, 16> telemetry;
+
+    using clk = std::chrono::high_resolution_clock;
+    using tp = std::chrono::time_point<clk>;
+    using dur = std::chrono::duration<long, std::milli>;
+
+    robot_interface_t(robot_chain_t *chain, bool permit_virtual = false);
+
+    ~robot_interface_t();
+
+    /*
+    Targets, interpolated positions and distances for every joint of the
+    chain, one pass per step over the state arrays so they vectorize.
+    Padding lanes compute garbage that is never read.
+    */
+    void get_servo_targets(const segment_t::tp &batch_time, int *target, int *interp, int *dist);
+
+    void update();
+
+    // hid_exit is left to the global destroy, other robots may still be open
+    void destroy();
+
+    static std::vector<std::wstring> enumerate(unsigned short vendor_id, unsigned short product_id);
+
+    void start();
+
+    // Flushes queued packets before returning
+    void stop();
+
+    void run();
+
+    void send(const packet_t &packet);
+
+    // Runs on the control thread, or inline before it is started
+    void transfer(const packet_t &packet, bool from_worker);
+
+    // Main thread
+    void apply_telemetry(const telemetry_t &t);
+
+    // Command with the ids of every servo in the chain
+    packet_t servo_list_packet(unsigned char command);
+
+    std::string get_hid_error();
+
+    // Positions arrive on a later update once the control thread runs
+    void read_all(bool set_pos = false);
+
+    //set no check
+    void set_servo(int id, int position, int millis = 1000);
+
+    //set no check
+    void set_servos(const std::vector<std::pair<int,int>> &poses, const int time = 1000);
+
+    //set no check
+    void set_servos(const std::pair<int,int> *poses, int count, const int time = 1000);
+
+    //set no check
+    void servos_off();
+
+    void init();
+
+    void set_robot_defaults();
+
+    int open(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number_w = nullptr);
+
+    void close();
+
+    // Try to close and open connection, do not destroy
+    void reset(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number_w = nullptr);
+
+    void debug_info(char *buffer, const size_t &size, size_t &offset);
+};
\ No newline at end of file
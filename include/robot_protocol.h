@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include <utility>
+
+/*
+The arm's servo controller over HID. Every frame is 0x55 0x55, the
+length counted from itself, the command and its parameters, positions
+and times little endian. Encoding and decoding only, robot_interface_t
+does the transfers.
+*/
+struct robot_packet_t {
+    enum type_t : uint8_t { WRITE, READ } type;
+    bool set_pos;
+    uint8_t size;
+    uint16_t delay_ms;
+    unsigned char bytes[64];
+};
+
+// Positions read back, applied on the main thread
+struct robot_telemetry_t {
+    bool set_pos;
+    uint8_t count;
+    uint8_t ids[32];
+    uint16_t positions[32];
+};
+
+namespace robot_protocol {
+    enum command_t : unsigned char {
+        MOVE = 3,
+        SERVOS_OFF = 20,
+        READ_POSITIONS = 21
+    };
+
+    // Servos a frame addresses at most, past it the packet overflows
+    static constexpr int max_servos = (sizeof robot_packet_t::bytes - 7) / 3;
+
+    // Every servo to its position over time milliseconds
+    void encode_move(const std::pair<int,int> *poses, int count, int time, robot_packet_t &packet);
+
+    // Command taking only a list of servo ids
+    void encode_servo_list(unsigned char command, const int *ids, int count, robot_packet_t &packet);
+
+    // Reply to READ_POSITIONS, false when too short to hold any
+    bool decode_positions(const unsigned char *bytes, int size, robot_telemetry_t &telemetry);
+}
\ No newline at end of file
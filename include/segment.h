@@ -2,11 +2,49 @@
 
 #include "common.h"
 #include "util.h"
+#include "sim_clock.h"
+#include "chain_state.h"
 
 struct mesh_t;
 
+// Same fields as servo_fields_T, bound to one joint of a chain_state_T
 template<typename SERVO_T = int, typename T = float>
-struct robot_servo_T {
+struct servo_view_T {
+    using dur_type = typename servo_fields_T<SERVO_T, T>::dur_type;
+    using tp = typename servo_fields_T<SERVO_T, T>::tp;
+
+    inline servo_view_T(chain_state_T<SERVO_T, T> &state, int joint):
+    servo_cur_position(state.servo_cur_position[joint]),
+    servo_end_position(state.servo_end_position[joint]),
+    servo_min(state.servo_min[joint]),
+    servo_max(state.servo_max[joint]),
+    servo_home(state.servo_home[joint]),
+    servo_num(state.servo_num[joint]),
+    degrees_per_second(state.degrees_per_second[joint]),
+    steps_per_degree(state.steps_per_degree[joint]),
+    last_command(state.last_command[joint]),
+    min_command_interval(state.min_command_interval[joint]),
+    min_command_threshold(state.min_command_threshold[joint]) {
+
+    }
+
+    SERVO_T &servo_cur_position, &servo_end_position;
+    SERVO_T &servo_min, &servo_max, &servo_home;
+    int &servo_num;
+
+    T &degrees_per_second, &steps_per_degree;
+    tp &last_command;
+
+    dur_type &min_command_interval;
+    SERVO_T &min_command_threshold;
+};
+
+/*
+Servo conversions and interpolation over FIELDS, either the values
+themselves (servo_fields_T) or a view into a chain's state (servo_view_T).
+*/
+template<typename SERVO_T = int, typename T = float, typename FIELDS = servo_fields_T<SERVO_T, T>>
+struct robot_servo_T : public FIELDS {
     inline robot_servo_T() {}
 
     inline robot_servo_T(int servo_num, 
@@ -16,34 +54,38 @@ struct robot_servo_T {
                   SERVO_T end_pos, 
                   SERVO_T cur_pos, 
                   T degrees_per_second, 
-                  T steps_per_degree):
-    servo_num(servo_num),
-    servo_min(servo_min),
-    servo_max(servo_max),
-    servo_home(servo_home),
-    servo_end_position(end_pos),
-    servo_cur_position(cur_pos),
-    degrees_per_second(degrees_per_second),
-    steps_per_degree(steps_per_degree) {
-
+                  T steps_per_degree) {
+        this->servo_num = servo_num;
+        this->servo_min = servo_min;
+        this->servo_max = servo_max;
+        this->servo_home = servo_home;
+        this->servo_end_position = end_pos;
+        this->servo_cur_position = cur_pos;
+        this->degrees_per_second = degrees_per_second;
+        this->steps_per_degree = steps_per_degree;
     }
 
+    inline robot_servo_T(chain_state_T<SERVO_T, T> &state, int joint)
+    :FIELDS(state, joint) { }
+
     using dur_type = long;
     using servo_type = SERVO_T;
     using value_type = T;
-    using clk = std::chrono::high_resolution_clock;
+    using clk = sim_clock_t;
     using tp = std::chrono::time_point<clk>;
     using dur = std::chrono::duration<dur_type, std::milli>;
 
-    SERVO_T servo_cur_position, servo_end_position;
-    SERVO_T servo_min, servo_max, servo_home;
-    int servo_num;
-
-    T degrees_per_second, steps_per_degree;
-    tp last_command;
-
-    dur_type min_command_interval = 20;
-    SERVO_T min_command_threshold = 1;
+    using FIELDS::servo_cur_position;
+    using FIELDS::servo_end_position;
+    using FIELDS::servo_min;
+    using FIELDS::servo_max;
+    using FIELDS::servo_home;
+    using FIELDS::servo_num;
+    using FIELDS::degrees_per_second;
+    using FIELDS::steps_per_degree;
+    using FIELDS::last_command;
+    using FIELDS::min_command_interval;
+    using FIELDS::min_command_threshold;
 
     template<typename RET = T, typename VT = SERVO_T>
     inline constexpr RET to_degrees(const VT &v) const {
@@ -58,11 +100,12 @@ struct robot_servo_T {
     template<typename RET = dur_type>
     inline constexpr RET get_elapsed_time() const {
         using _dur = std::chrono::duration<RET>;
-        return (RET)std::chrono::duration_cast<_dur>(clk::now() - last_command).count();
+        // Rendering samples up to a tick behind the latest command
+        return (RET)std::max<RET>(std::chrono::duration_cast<_dur>(clk::now() - last_command).count(), RET(0));
     }
     
     inline constexpr bool movement_complete() const {
-        return get_servo_interpolated() <= min_command_threshold;
+        return get_servo_interpolated() == servo_end_position;
     }
 
     inline constexpr bool ready_for_command() const {
@@ -131,13 +174,13 @@ struct robot_servo_T {
 
 using robot_servo_t = robot_servo_T<int, float>;
 
-template<typename mesh_base = mesh_t/*, typename robot_servo_type_T = robot_servo_T<int, float>*/>
-struct segment_T : public robot_servo_T<int, float> {
-    using robot_servo_type = robot_servo_T<int, float>;
-    segment_T() {}
+template<typename mesh_base = mesh_t>
+struct segment_T : public robot_servo_T<int, float, servo_view_T<int, float>> {
+    using robot_servo_type = robot_servo_T<int, float, servo_view_T<int, float>>;
 
-    inline segment_T(segment_T *parent, mesh_base *mesh, const robot_servo_type &servo_config, const glm::vec3 &rotation_axis, const float &length)
-    :robot_servo_type(servo_config),parent(parent),mesh(mesh),rotation_axis(rotation_axis),length(length) { }
+    // Servo state lives in slot joint of state, which must outlive the segment
+    inline segment_T(segment_T *parent, mesh_base *mesh, chain_state_t &state, int joint, const glm::vec3 &rotation_axis, const float &length, const glm::vec3 &offset = glm::vec3(0.0f))
+    :robot_servo_type(state, joint),joint(joint),parent(parent),mesh(mesh),rotation_axis(rotation_axis),length(length),offset(offset) { }
 
     inline constexpr float get_clamped_rotation(const bool &allow_interpolate = false) const {
         return util::wrap(get_rotation(allow_interpolate), -180, 180);
@@ -191,30 +234,28 @@ struct segment_T : public robot_servo_T<int, float> {
     }
 
     inline constexpr glm::vec3 get_origin(const bool &allow_interpolate = true) const {
+        // The root's offset places the whole chain
         if (!parent) {
             assert(mesh && "Mesh null\n");
-            return mesh->position;
+            return mesh->position + offset * model_scale;
         }
 
-        if (servo_num == 5) { //shift forward just for this servo
-            glm::mat4 iden = parent->get_rotation_matrix(allow_interpolate);
-            auto trn = glm::vec3(2.54f * -model_scale, 0., 0.);
-            iden = glm::translate(iden, trn);
-            iden = glm::rotate(iden, glm::radians(90.0f), {0,0,1});
+        auto origin = parent->get_segment_vector(allow_interpolate) + parent->get_origin(allow_interpolate);
 
-            return parent->get_segment_vector(allow_interpolate) + 
-                   parent->get_origin(allow_interpolate) + 
-                   glm::vec3(iden[3]);
-        }
+        // Fixed shift from the parent's tip, in the parent's frame
+        if (offset != glm::vec3(0.0f))
+            origin += glm::vec3(parent->get_rotation_matrix(allow_interpolate) * glm::vec4(offset * model_scale, 0.0f));
 
-        return parent->get_segment_vector(allow_interpolate) + parent->get_origin(allow_interpolate);
+        return origin;
     }
 
+    int joint;
     float model_scale = 0.1;
     glm::vec3 rotation_axis;
-    segment_T<> *parent;
+    segment_T *parent;
     glm::vec3 debug_color;
     float length;
+    glm::vec3 offset;
     mesh_base *mesh;
 };
 
@@ -8,6 +8,7 @@
 struct shader_t {
     GLuint shaderId;
     GLenum type;
+    std::string path;
 
     inline shader_t(const GLenum &type)
     :type(type),shaderId(gluninitialized) { }
@@ -16,5 +17,6 @@ struct shader_t {
         return shaderId != gluninitialized;
     }
 
+    // Keeps the previously compiled shader if compilation fails
     bool load(const std::string &path);
 };
\ No newline at end of file
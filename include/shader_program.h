@@ -125,5 +125,10 @@ struct shader_program_t {
         glUseProgram(programId);
     }
 
+    bool has_shader(const shader_t *shader) const {
+        return std::find(shaders.begin(), shaders.end(), shader) != shaders.end();
+    }
+
+    // Keeps the previously linked program if linking fails
     bool load();
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <algorithm>
+
+/*
+Simulation clock advanced in fixed ticks.
+Satisfies the standard Clock requirements so the servo model and robot
+interface time against it exactly like a chrono clock. now() returns the
+time of the current tick while simulating and an interpolated time
+between the last two ticks while rendering.
+*/
+struct sim_clock_t {
+    using rep = int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<sim_clock_t>;
+
+    static constexpr bool is_steady = true;
+
+    static inline double tick_rate = 240.0;
+    // Ticks run per frame at most, a longer stall drops time instead of spiralling
+    static inline int max_ticks = 16;
+
+    static inline duration time{0};
+    static inline duration sampled{0};
+    static inline double accumulator = 0;
+    static inline double alpha = 0;
+    static inline uint64_t ticks = 0;
+    static inline int frame_ticks = 0;
+
+    static inline time_point now() noexcept {
+        return time_point(sampled);
+    }
+
+    static inline double get_dt() {
+        return 1.0 / tick_rate;
+    }
+
+    static inline duration to_duration(double seconds) {
+        return std::chrono::duration_cast<duration>(std::chrono::duration<double>(seconds));
+    }
+
+    // Call once per frame with the wall time since the last frame
+    static inline void advance(double frame_time) {
+        accumulator = std::min(accumulator + std::max(frame_time, 0.0), max_ticks * get_dt());
+        frame_ticks = 0;
+        sampled = time;
+    }
+
+    // Runs the next pending tick, loop until false
+    static inline bool step() {
+        const double dt = get_dt();
+
+        if (accumulator < dt)
+            return false;
+
+        accumulator -= dt;
+        time += to_duration(dt);
+        sampled = time;
+        ticks++;
+        frame_ticks++;
+
+        return true;
+    }
+
+    // Samples between the previous and current tick for drawing
+    static inline void begin_render() {
+        const double dt = get_dt();
+
+        alpha = accumulator / dt;
+        sampled = time - to_duration(dt * (1.0 - alpha));
+    }
+};
\ No newline at end of file
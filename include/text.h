@@ -1,7 +1,7 @@
 #pragma once
 
 #include <glm/gtc/type_ptr.hpp>
-#include "common.h"
+#include "app.h"
 
 extern float title_height;
 extern float value_subpos_x;
@@ -76,4 +76,28 @@ struct text_t : public text_data {
     void set_attrib_pointers();
 };
 
+/*
+Vertex storage that survives string changes. Both the CPU copy and the
+GL buffer grow geometrically and never shrink, and upload() only sends
+the range that differs from what was uploaded last.
+*/
+struct text_buffer_t {
+    std::vector<text_t> verticies, uploaded;
+    GLuint vao, vbo, vertexCount, capacity;
+
+    text_buffer_t();
+
+    ~text_buffer_t();
+
+    // Storage for at least count verticies, resets vertexCount
+    text_t *begin(const size_t &count);
+
+    // Copies verticies after the current vertexCount
+    void append(const text_t *src, const size_t &count);
+
+    void upload();
+
+    void render();
+};
+
 extern void add_rect(text_t *buffer, unsigned int &vertexCount, glm::vec4 XYWH, glm::vec4 UVWH = glm::vec4(0,0,1,1.), bool is_color = false);
\ No newline at end of file
@@ -23,5 +23,6 @@ struct texture_t {
 
     bool generate(const glm::vec4 &rgba);
 
+    // Keeps the previous texture if the image fails to load
     bool load(const std::string &path);
 };
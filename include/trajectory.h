@@ -0,0 +1,63 @@
+#pragma once
+
+#include "robot_description.h"
+#include "worker_pool.h"
+
+/*
+A move of a chain from where its servos are to their end positions, as
+robot_servo_T interpolates it: every servo moves linearly in steps at
+its own speed and stops when it arrives, the move ends with the slowest.
+*/
+struct trajectory_t {
+    static constexpr int capacity = chain_state_t::capacity;
+
+    int count;
+    float start[capacity], end[capacity];
+    // Steps per second, degrees per step and home to turn steps into angles
+    float rate[capacity], steps_per_degree[capacity], home[capacity];
+    float duration;
+
+    trajectory_t();
+
+    // From the current interpolated positions to the end positions
+    trajectory_t(const robot_chain_t &chain);
+
+    // Seconds until servo i arrives
+    inline float arrival(int i) const {
+        return rate[i] > 0.0f ? std::abs(end[i] - start[i]) / rate[i] : 0.0f;
+    }
+
+    void degrees_at(const float &time, float *degrees) const;
+};
+
+/*
+Samples a trajectory and checks each sample against the chain's collision
+geometry. Steps are bounded so no point of the arm moves further than
+tolerance between samples: each moving joint contributes its angular
+speed times the reach of everything it carries, and the bound is redone
+whenever a servo arrives. Samples are checked in parallel on threads
+started with the validator, handed out in time order so the first
+collision found early stops later samples.
+*/
+struct trajectory_validator_t {
+    // World units any point may move between samples
+    float tolerance;
+    // Cap on samples per move, past it they are spread evenly
+    int max_samples;
+    // Fewer samples than this per thread run on the calling thread
+    int min_samples_per_thread;
+    worker_pool_t pool;
+
+    // One thread per core unless given, 1 validates on the calling thread only
+    trajectory_validator_t(int threads = 0);
+
+    // Seconds into the move of the first colliding sample, negative when clear
+    float validate(const robot_chain_t &chain, const trajectory_t &move, collision_contact_t *contact = nullptr);
+
+    // Sample times, increasing, ending at the move's duration. The start is
+    // left out, it is where the arm already is
+    void sample(const robot_chain_t &chain, const trajectory_t &move, std::vector<float> &times) const;
+
+    // Furthest any point carried by each segment can be from its origin
+    static void get_reach(const robot_chain_t &chain, float *reach);
+};
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "app.h"
+#include "shader_program.h"
+#include "text.h"
+
+// Draw order between batches, colored quads sit below text
+enum ui_layer_t {
+    UI_LAYER_COLOR,
+    UI_LAYER_TEXT
+};
+
+/*
+Collects the quads of every visible element into one vertex stream per
+layer/shader/texture combination, then uploads and draws each stream
+once. Elements keep their own quads and only rebuild them when modified.
+*/
+struct ui_batch_t {
+    struct batch_t {
+        ui_layer_t layer;
+        shader_program_t *shader;
+        texture_t *texture;
+        text_buffer_t buffer;
+    };
+
+    std::vector<batch_t*> batches;
+
+    ~ui_batch_t();
+
+    // Call once per frame before walking the element tree
+    void begin();
+
+    void add(const ui_layer_t &layer, shader_program_t *shader, texture_t *texture, const text_buffer_t &quads);
+
+    void submit();
+
+    GLuint get_draw_count() const;
+
+    protected:
+    batch_t *get_batch(const ui_layer_t &layer, shader_program_t *shader, texture_t *texture);
+};
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "app.h"
+#include "texture.h"
+#include "ui_element.h"
+#include "ui_batch.h"
+
+/*
+Keeps the rendered UI in an offscreen texture. The element tree is only
+re-batched into it when an element is modified, shown or hidden, or the
+framebuffer is resized. Every frame composites the texture with one quad.
+*/
+struct ui_cache_t {
+    GLuint fbo;
+    texture_t texture;
+    text_buffer_t quad;
+    shader_program_t *shader;
+    glm::ivec2 size;
+    bool dirty;
+    int rebuilds;
+
+    ui_cache_t(shader_program_t *shader);
+
+    ~ui_cache_t();
+
+    // Force a rebuild, for state outside the elements (projection, shaders)
+    inline void invalidate() {
+        dirty = true;
+    }
+
+    bool resize(int width, int height);
+
+    bool render(ui_element_t *root, ui_batch_t *batch);
+
+    protected:
+    bool rebuild(ui_element_t *root, ui_batch_t *batch);
+};
\ No newline at end of file
@@ -1,18 +1,21 @@
 #pragma once
 
-#include "common.h"
+#include "app.h"
+#include "text.h"
+
+struct ui_batch_t;
 
 struct ui_element_t {
     std::vector<ui_element_t*> children;
     GLFWwindow *window;
     glm::vec4 XYWH;
-    GLuint vao, vbo, vertexCount;
-    bool modified, loaded, hidden;
+    text_buffer_t buffer;
+    bool modified, loaded, hidden, drawn_hidden;
     using callback_t = std::function<void()>;
     callback_t pre_render_callback;
 
     ui_element_t()
-    :modified(true),loaded(false),hidden(false),window(0) {}
+    :modified(true),loaded(false),hidden(false),drawn_hidden(false),window(0) {}
 
     ui_element_t(const ui_element_t &ui)
     :ui_element_t() {
@@ -37,7 +40,14 @@ struct ui_element_t {
 
     virtual bool redraw();
 
-    virtual bool render();
+    // Runs pre render callbacks of visible elements, once per frame
+    virtual bool update();
+
+    // Whether a visible element changed since it was last batched
+    virtual bool is_dirty();
+
+    // Rebuilds modified quads and adds the visible ones to the batch
+    virtual bool render(ui_batch_t *batch);
 
     virtual bool mesh();
 
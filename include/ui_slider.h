@@ -44,5 +44,5 @@ struct ui_slider_t : public ui_element_t {
 
     bool mesh() override;
 
-    bool render() override;
+    bool render(ui_batch_t *batch) override;
 };
\ No newline at end of file
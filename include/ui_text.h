@@ -33,7 +33,7 @@ struct ui_text_t : public ui_element_t {
 
     bool reset() override;
 
-    bool render() override;
+    bool render(ui_batch_t *batch) override;
 
     std::string get_element_name() override;
 
@@ -51,6 +51,17 @@ namespace util {
         return ret;
     }
 
+    // Appends to a fixed buffer at offset, always null terminated, never allocates
+    template<typename ...Args>
+    inline void format_to(char *buffer, const size_t &size, size_t &offset, std::format_string<Args...> fmt, Args &&... args) {
+        if (offset + 1 >= size)
+            return;
+
+        auto result = std::format_to_n(buffer + offset, size - offset - 1, fmt, std::forward<Args>(args)...);
+        offset = std::min<size_t>(size - 1, result.out - buffer);
+        buffer[offset] = '\0';
+    }
+
     // Also known as clamp
     template<typename T = float, typename T2 = T, typename T3 = T>
     constexpr inline T clip(const T &v, const T2 &min, const T3 &max) {
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+/*
+Threads started once and woken for each run, so a parallel pass costs a
+wake up rather than a thread start. The calling thread takes part as
+worker 0. Every thread sees every run and the next one only starts once
+all have finished, workers past the run's count return at once. Runs
+come from one thread at a time.
+*/
+struct worker_pool_t {
+    std::vector<std::thread> threads;
+    std::atomic<bool> running;
+    std::atomic<uint32_t> generation;
+    std::atomic<int> pending;
+
+    // Current run, written before generation is bumped
+    int active;
+    void (*job)(void *context, int worker);
+    void *context;
+
+    // Workers including the caller, at least one
+    worker_pool_t(int size);
+
+    ~worker_pool_t();
+
+    inline int size() const {
+        return threads.size() + 1;
+    }
+
+    // Calls func(worker) on workers [0, count), returns when all are done
+    template<typename F>
+    void run(int count, F &func) {
+        count = std::clamp(count, 1, size());
+
+        if (count == 1) {
+            func(0);
+            return;
+        }
+
+        context = &func;
+        job = [](void *context, int worker) {
+            (*static_cast<F*>(context))(worker);
+        };
+
+        dispatch(count);
+        func(0);
+        wait();
+    }
+
+    void dispatch(int count);
+
+    void wait();
+
+    void loop(int worker);
+};
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec4 aColor;
+
+out vec4 color;
+
+uniform mat4 view, projection;
+
+void main() {
+    gl_Position = projection * view * vec4(aPosition, 1.0);
+    color = aColor;
+}
\ No newline at end of file
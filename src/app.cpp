@@ -0,0 +1,23 @@
+#include "app.h"
+
+glm::ivec4 initial_window(0);
+glm::ivec4 current_window(0);
+bool fullscreen = false;
+bool headless = false;
+bool render_enabled = true;
+bool exit_requested = false;
+bool on_demand = false;
+bool debug_ui = false;
+bool model_interpolation = true;
+float mouseSensitivity = 0.05f;
+float preciseSpeed = 0.1f;
+float movementSpeed = 10.0f;
+float rapidSpeed = 20.0f;
+glm::mat4 viewport_inversion(1.);
+GLFWwindow *window;
+GLuint default_framebuffer = 0;
+GLint uni_projection;
+GLint uni_model;
+GLint uni_norm;
+GLint uni_view;
+vec3_d robot_target;
\ No newline at end of file
@@ -62,8 +62,8 @@ void camera_t::keyboard(GLFWwindow *window, float deltaTime) {
         return;
 
     float movementFactor = movementSpeed;
-    bool precise = (glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS);
-    bool rapid = (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS);
+    bool precise = key_down(GLFW_KEY_RIGHT_SHIFT);
+    bool rapid = key_down(GLFW_KEY_LEFT_CONTROL);
 
     if (rapid && precise) {
         
@@ -75,27 +75,27 @@ void camera_t::keyboard(GLFWwindow *window, float deltaTime) {
         movementFactor = preciseSpeed;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
+    if (key_down(GLFW_KEY_W)) {
         position += front * deltaTime * movementFactor;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
+    if (key_down(GLFW_KEY_S)) {
         position -= front * deltaTime * movementFactor;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
+    if (key_down(GLFW_KEY_A)) {
         position -= right  * deltaTime * movementFactor;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
+    if (key_down(GLFW_KEY_D)) {
         position += right * deltaTime * movementFactor;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
+    if (key_down(GLFW_KEY_SPACE)) {
         position += up * deltaTime * movementFactor;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
+    if (key_down(GLFW_KEY_LEFT_SHIFT)) {
         position -= up * deltaTime * movementFactor;
     }
 }
\ No newline at end of file
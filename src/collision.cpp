@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <assert.h>
+
+#include "collision.h"
+#include "mesh.h"
+
+collision_aabb_t collision_aabb_t::transformed(const glm::mat4 &transform) const {
+    const glm::vec3 center = (min + max) * 0.5f;
+    const glm::vec3 extent = (max - min) * 0.5f;
+    const glm::vec3 world_center = glm::vec3(transform * glm::vec4(center, 1.0f));
+    glm::vec3 world_extent(0.0f);
+
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            world_extent[i] += std::abs(transform[j][i]) * extent[j];
+
+    return {world_center - world_extent, world_center + world_extent};
+}
+
+collision_aabb_t collision_aabb_t::empty() {
+    return {glm::vec3(INFINITY), glm::vec3(-INFINITY)};
+}
+
+void collision_bvh_t::build(const mesh_t &mesh) {
+    std::vector<collision_triangle_t> tris(mesh.verticies.size() / 3);
+
+    for (int i = 0; i < tris.size(); i++)
+        for (int k = 0; k < 3; k++)
+            tris[i].v[k] = mesh.verticies[i * 3 + k].vertex;
+
+    build(std::move(tris));
+}
+
+void collision_bvh_t::build(std::vector<collision_triangle_t> &&tris) {
+    triangles = std::move(tris);
+    nodes.clear();
+
+    if (triangles.empty())
+        return;
+
+    nodes.reserve(triangles.size() / leaf_size * 2 + 1);
+
+    std::vector<glm::vec3> centroids(triangles.size());
+
+    for (int i = 0; i < triangles.size(); i++)
+        centroids[i] = (triangles[i].v[0] + triangles[i].v[1] + triangles[i].v[2]) / 3.0f;
+
+    build_node(0, triangles.size(), centroids);
+}
+
+uint32_t collision_bvh_t::build_node(uint32_t first, uint32_t count, std::vector<glm::vec3> &centroids) {
+    const uint32_t index = nodes.size();
+    auto box = collision_aabb_t::empty();
+    auto centers = collision_aabb_t::empty();
+
+    for (uint32_t i = first; i < first + count; i++) {
+        for (auto &v : triangles[i].v)
+            box.grow(v);
+        centers.grow(centroids[i]);
+    }
+
+    nodes.push_back({box, first, count, 0});
+
+    if (count <= leaf_size)
+        return index;
+
+    const glm::vec3 size = centers.max - centers.min;
+    const int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    const uint32_t half = count / 2;
+
+    // Median by centroid, triangles and centroids move together
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; i++)
+        order[i] = first + i;
+
+    std::nth_element(order.begin(), order.begin() + half, order.end(), [&](uint32_t a, uint32_t b) {
+        return centroids[a][axis] < centroids[b][axis];
+    });
+
+    std::vector<collision_triangle_t> tris(count);
+    std::vector<glm::vec3> centers_sorted(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        tris[i] = triangles[order[i]];
+        centers_sorted[i] = centroids[order[i]];
+    }
+
+    std::copy(tris.begin(), tris.end(), triangles.begin() + first);
+    std::copy(centers_sorted.begin(), centers_sorted.end(), centroids.begin() + first);
+
+    nodes[index].count = 0;
+    build_node(first, half, centroids);
+    nodes[index].right = build_node(first + half, count - half, centroids);
+
+    return index;
+}
+
+namespace collision {
+    template<int NA, int NB>
+    static inline bool separated(const glm::vec3 &axis, const glm::vec3 *a, const glm::vec3 *b) {
+        // Parallel edges give no axis, another one decides
+        if (glm::dot(axis, axis) < 1e-12f)
+            return false;
+
+        float amin = INFINITY, amax = -INFINITY, bmin = INFINITY, bmax = -INFINITY;
+
+        for (int i = 0; i < NA; i++) {
+            float p = glm::dot(axis, a[i]);
+            amin = std::min(amin, p);
+            amax = std::max(amax, p);
+        }
+
+        for (int i = 0; i < NB; i++) {
+            float p = glm::dot(axis, b[i]);
+            bmin = std::min(bmin, p);
+            bmax = std::max(bmax, p);
+        }
+
+        return amax < bmin || bmax < amin;
+    }
+
+    bool triangles_overlap(const glm::vec3 *a, const glm::vec3 *b) {
+        const glm::vec3 ea[3] = {a[1] - a[0], a[2] - a[1], a[0] - a[2]};
+        const glm::vec3 eb[3] = {b[1] - b[0], b[2] - b[1], b[0] - b[2]};
+        const glm::vec3 na = glm::cross(ea[0], ea[1]);
+        const glm::vec3 nb = glm::cross(eb[0], eb[1]);
+
+        if (separated<3, 3>(na, a, b) || separated<3, 3>(nb, a, b))
+            return false;
+
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                if (separated<3, 3>(glm::cross(ea[i], eb[j]), a, b))
+                    return false;
+
+        // In plane edge normals, only coplanar triangles can need them
+        for (int i = 0; i < 3; i++)
+            if (separated<3, 3>(glm::cross(na, ea[i]), a, b) || separated<3, 3>(glm::cross(nb, eb[i]), a, b))
+                return false;
+
+        return true;
+    }
+
+    bool triangle_box_overlap(const glm::vec3 *triangle, const collision_aabb_t &box) {
+        glm::vec3 corners[8];
+
+        for (int i = 0; i < 8; i++)
+            corners[i] = glm::vec3(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z);
+
+        const glm::vec3 e[3] = {triangle[1] - triangle[0], triangle[2] - triangle[1], triangle[0] - triangle[2]};
+
+        for (int i = 0; i < 3; i++) {
+            glm::vec3 axis(0.0f);
+            axis[i] = 1.0f;
+
+            if (separated<3, 8>(axis, triangle, corners))
+                return false;
+
+            for (int j = 0; j < 3; j++)
+                if (separated<3, 8>(glm::cross(e[j], axis), triangle, corners))
+                    return false;
+        }
+
+        return !separated<3, 8>(glm::cross(e[0], e[1]), triangle, corners);
+    }
+}
+
+void collision_checker_t::clear() {
+    bodies.clear();
+}
+
+void collision_checker_t::add(const collision_bvh_t *bvh, const glm::mat4 &transform, int parent, bool fixed) {
+    auto bounds = bvh->empty() ? collision_aabb_t::empty() : bvh->nodes[0].box.transformed(transform);
+    bodies.push_back({bvh, transform, bounds, parent, fixed});
+}
+
+bool collision_checker_t::check(const collision_scene_t &scene, collision_contact_t *contact) const {
+    auto hit = [&](int a, int b) {
+        if (contact)
+            *contact = {a, b};
+        return true;
+    };
+
+    for (int a = 0; a < bodies.size(); a++) {
+        const auto &body = bodies[a];
+
+        if (body.bvh->empty())
+            continue;
+
+        if (!body.fixed) {
+            if (scene.has_floor && body.bounds.min.y < scene.floor_height && body_below(body, scene.floor_height))
+                return hit(a, collision_contact_t::FLOOR);
+
+            for (int k = 0; k < scene.boxes.size(); k++)
+                if (body.bounds.overlaps(scene.boxes[k]) && body_hits_box(body, scene.boxes[k]))
+                    return hit(a, collision_contact_t::BOX - k);
+        }
+
+        for (int b = a + 1; b < bodies.size(); b++) {
+            const auto &other = bodies[b];
+
+            if (other.bvh->empty() || other.parent == a || body.parent == b)
+                continue;
+
+            if (body.bounds.overlaps(other.bounds) && bodies_collide(body, other))
+                return hit(a, b);
+        }
+    }
+
+    return false;
+}
+
+bool collision_checker_t::bodies_collide(const body_t &a, const body_t &b) const {
+    // Work in a's mesh space, only b's volumes move
+    const glm::mat4 b_to_a = glm::inverse(a.transform) * b.transform;
+    const auto &na = a.bvh->nodes;
+    const auto &nb = b.bvh->nodes;
+
+    constexpr int stack_size = 256;
+    uint32_t stack[stack_size][2];
+    int top = 0;
+
+    stack[top][0] = 0;
+    stack[top][1] = 0;
+    top++;
+
+    while (top > 0) {
+        top--;
+        const auto &node_a = na[stack[top][0]];
+        const auto &node_b = nb[stack[top][1]];
+        const uint32_t ia = stack[top][0], ib = stack[top][1];
+
+        if (!node_a.box.overlaps(node_b.box.transformed(b_to_a)))
+            continue;
+
+        if (node_a.leaf() && node_b.leaf()) {
+            for (uint32_t j = node_b.first; j < node_b.first + node_b.count; j++) {
+                const auto &tb = b.bvh->triangles[j];
+                const glm::vec3 vb[3] = {
+                    glm::vec3(b_to_a * glm::vec4(tb.v[0], 1.0f)),
+                    glm::vec3(b_to_a * glm::vec4(tb.v[1], 1.0f)),
+                    glm::vec3(b_to_a * glm::vec4(tb.v[2], 1.0f))
+                };
+
+                for (uint32_t i = node_a.first; i < node_a.first + node_a.count; i++)
+                    if (collision::triangles_overlap(a.bvh->triangles[i].v, vb))
+                        return true;
+            }
+            continue;
+        }
+
+        assert(top + 2 <= stack_size && "Collision stack overflow");
+
+        // Descend the side that is not a leaf, the larger one when neither is
+        const glm::vec3 size_a = node_a.box.max - node_a.box.min;
+        const glm::vec3 size_b = node_b.box.max - node_b.box.min;
+        const bool split_a = node_b.leaf() || (!node_a.leaf() && glm::dot(size_a, size_a) >= glm::dot(size_b, size_b));
+
+        if (split_a) {
+            stack[top][0] = ia + 1;
+            stack[top++][1] = ib;
+            stack[top][0] = node_a.right;
+            stack[top++][1] = ib;
+        } else {
+            stack[top][0] = ia;
+            stack[top++][1] = ib + 1;
+            stack[top][0] = ia;
+            stack[top++][1] = node_b.right;
+        }
+    }
+
+    return false;
+}
+
+bool collision_checker_t::body_hits_box(const body_t &body, const collision_aabb_t &box) const {
+    const auto &nodes = body.bvh->nodes;
+
+    constexpr int stack_size = 128;
+    uint32_t stack[stack_size];
+    int top = 0;
+
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const uint32_t index = stack[--top];
+        const auto &node = nodes[index];
+
+        if (!node.box.transformed(body.transform).overlaps(box))
+            continue;
+
+        if (node.leaf()) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                const auto &t = body.bvh->triangles[i];
+                const glm::vec3 v[3] = {
+                    glm::vec3(body.transform * glm::vec4(t.v[0], 1.0f)),
+                    glm::vec3(body.transform * glm::vec4(t.v[1], 1.0f)),
+                    glm::vec3(body.transform * glm::vec4(t.v[2], 1.0f))
+                };
+
+                if (collision::triangle_box_overlap(v, box))
+                    return true;
+            }
+            continue;
+        }
+
+        assert(top + 2 <= stack_size && "Collision stack overflow");
+
+        stack[top++] = index + 1;
+        stack[top++] = node.right;
+    }
+
+    return false;
+}
+
+bool collision_checker_t::body_below(const body_t &body, const float &height) const {
+    const auto &nodes = body.bvh->nodes;
+
+    constexpr int stack_size = 128;
+    uint32_t stack[stack_size];
+    int top = 0;
+
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const uint32_t index = stack[--top];
+        const auto &node = nodes[index];
+        const auto bounds = node.box.transformed(body.transform);
+
+        if (bounds.min.y >= height)
+            continue;
+
+        if (node.leaf()) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+                for (auto &v : body.bvh->triangles[i].v)
+                    if ((body.transform * glm::vec4(v, 1.0f)).y < height)
+                        return true;
+            continue;
+        }
+
+        assert(top + 2 <= stack_size && "Collision stack overflow");
+
+        stack[top++] = index + 1;
+        stack[top++] = node.right;
+    }
+
+    return false;
+}
\ No newline at end of file
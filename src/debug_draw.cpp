@@ -0,0 +1,108 @@
+#include "debug_draw.h"
+
+debug_draw_t::debug_draw_t(shader_program_t *program):
+        program(program),
+        vao(0),
+        vbo(0),
+        capacity(0) {
+    const size_t stride = sizeof(debug_vertex_t);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*) (offsetof(debug_vertex_t, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*) (offsetof(debug_vertex_t, color)));
+    glBindVertexArray(0);
+}
+
+debug_draw_t::~debug_draw_t() {
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+}
+
+void debug_draw_t::add_line(const glm::vec3 &origin, const glm::vec3 &end, const glm::vec4 &color) {
+    lines.push_back({origin, color});
+    lines.push_back({end, color});
+}
+
+void debug_draw_t::add_point(const glm::vec3 &origin, const float &radius, const glm::vec4 &color) {
+    points.push_back({origin, radius, color});
+}
+
+void debug_draw_t::add_axes(const glm::vec3 &origin, const glm::mat4 &mat, const float &length) {
+    const glm::vec4 colors[3] = {{1,0,0,1}, {0,1,0,1}, {0,0,1,1}};
+
+    for (int i = 0; i < 3; i++)
+        add_line(origin, origin + glm::vec3(mat[i]) * length, colors[i]);
+}
+
+void debug_draw_t::clear() {
+    lines.clear();
+    triangles.clear();
+    points.clear();
+}
+
+void debug_draw_t::upload() {
+    const size_t stride = sizeof(debug_vertex_t);
+    const size_t count = lines.size() + triangles.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    if (count > capacity)
+        capacity = std::max<size_t>(count, capacity * 2);
+
+    // Orphan the previous frame's storage so the driver never waits on it
+    glBufferData(GL_ARRAY_BUFFER, capacity * stride, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, lines.size() * stride, lines.data());
+    glBufferSubData(GL_ARRAY_BUFFER, lines.size() * stride, triangles.size() * stride, triangles.data());
+}
+
+void debug_draw_t::render(camera_t *camera) {
+    assert(program && "Program null\n");
+
+    // Billboards face the camera, so points are expanded here
+    for (auto &p : points) {
+        float r = p.radius * point_scale;
+        glm::vec3 cr = camera->right * glm::vec3(0.5f) * r;
+        glm::vec3 cu = camera->up * glm::vec3(0.5f) * r;
+        glm::vec3 v1 = p.position + cr + cu,
+                  v2 = p.position + cr - cu,
+                  v3 = p.position - cr - cu,
+                  v4 = p.position - cr + cu;
+
+        triangles.push_back({v1, p.color});
+        triangles.push_back({v2, p.color});
+        triangles.push_back({v3, p.color});
+        triangles.push_back({v1, p.color});
+        triangles.push_back({v3, p.color});
+        triangles.push_back({v4, p.color});
+    }
+
+    if (lines.size() + triangles.size() < 1) {
+        clear();
+        return;
+    }
+
+    program->use();
+    program->set_m4("view", camera->get_view_matrix());
+    program->set_m4("projection", camera->get_projection_matrix());
+
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+
+    upload();
+
+    glBindVertexArray(vao);
+    glDrawArrays(GL_LINES, 0, lines.size());
+    glDrawArrays(GL_TRIANGLES, lines.size(), triangles.size());
+    glBindVertexArray(0);
+
+    if (debug_pedantic)
+        printf("Debug draw: %li line verticies, %li point verticies, capacity: %i\n", lines.size(), triangles.size(), capacity);
+
+    clear();
+}
\ No newline at end of file
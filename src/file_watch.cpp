@@ -0,0 +1,102 @@
+#include <set>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "file_watch.h"
+
+file_watch_t::file_watch_t():
+        fd(-1) {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (fd < 0)
+        fprintf(stderr, "Failed to start file watch (nonfatal), %s\n", strerror(errno));
+}
+
+file_watch_t::~file_watch_t() {
+    if (isLoaded())
+        close(fd);
+}
+
+bool file_watch_t::add_directory(const std::string &directory) {
+    if (!isLoaded())
+        return glfail;
+
+    for (auto &dir : directories)
+        if (dir.second == directory)
+            return glsuccess;
+
+    int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if (wd < 0) {
+        fprintf(stderr, "Failed to watch directory %s, %s\n", directory.c_str(), strerror(errno));
+        return glfail;
+    }
+
+    directories[wd] = directory;
+
+    if (debug_mode)
+        fprintf(stderr, "Watching directory %s\n", directory.c_str());
+
+    return glsuccess;
+}
+
+bool file_watch_t::watch(const std::string &path, callback_t callback) {
+    std::string directory = ".";
+    auto sep = path.find_last_of('/');
+
+    if (sep != std::string::npos)
+        directory = path.substr(0, sep);
+
+    callbacks[path].push_back(callback);
+
+    return add_directory(directory);
+}
+
+void file_watch_t::update() {
+    if (!isLoaded())
+        return;
+
+    alignas(inotify_event) char buffer[4096];
+    std::set<std::string> changed;
+
+    while (true) {
+        ssize_t len = read(fd, &buffer[0], sizeof buffer);
+
+        if (len <= 0)
+            break;
+
+        for (char *ptr = &buffer[0]; ptr < &buffer[0] + len;) {
+            auto *event = reinterpret_cast<inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (!event->len || !directories.contains(event->wd))
+                continue;
+
+            std::string path = directories[event->wd] + "/" + event->name;
+
+            if (callbacks.contains(path))
+                changed.insert(path);
+        }
+    }
+
+    // A save can produce several events, reload each file once
+    for (auto &path : changed) {
+        auto start = hrc::now();
+        bool ret = glsuccess;
+
+        for (auto &callback : callbacks[path])
+            ret |= callback(path);
+
+        double ms = dur(hrc::now() - start).count() * 1000.0;
+
+        if (ret)
+            fprintf(stderr, "Failed to reload %s, keeping previous (%.2f ms)\n", path.c_str(), ms);
+        else
+            fprintf(stderr, "Reloaded %s in %.2f ms\n", path.c_str(), ms);
+    }
+
+    if (changed.size() > 0)
+        request_redraw();
+}
\ No newline at end of file
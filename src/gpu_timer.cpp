@@ -0,0 +1,108 @@
+#define GL_GLEXT_PROTOTYPES
+
+#include "gpu_timer.h"
+#include "util.h"
+
+gpu_timer_t::gpu_timer_t():
+        queries{0},
+        pending{false},
+        results{0},
+        frame(0),
+        active(-1),
+        supported(false) {
+
+}
+
+gpu_timer_t::~gpu_timer_t() {
+    if (supported)
+        glDeleteQueries(latency * GPU_PASS_COUNT, &queries[0][0]);
+}
+
+bool gpu_timer_t::init() {
+    GLint major = 0, minor = 0, count = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    supported = major > 3 || (major == 3 && minor >= 3);
+
+    for (GLint i = 0; i < count && !supported; i++) {
+        const char *extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+
+        if (extension && (!strcmp(extension, "GL_ARB_timer_query") || !strcmp(extension, "GL_EXT_timer_query")))
+            supported = true;
+    }
+
+    if (!supported) {
+        fprintf(stderr, "GPU timer queries unavailable (nonfatal), GL %i.%i\n", major, minor);
+        return glfail;
+    }
+
+    glGenQueries(latency * GPU_PASS_COUNT, &queries[0][0]);
+
+    return glsuccess;
+}
+
+void gpu_timer_t::begin(gpu_pass_t pass) {
+    if (!supported || active > -1)
+        return;
+
+    const int slot = frame % latency;
+
+    // Result from latency frames ago not in yet, skip the pass rather than wait
+    if (pending[slot][pass])
+        return;
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[slot][pass]);
+    active = pass;
+}
+
+void gpu_timer_t::end() {
+    if (active < 0)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[frame % latency][active] = true;
+    active = -1;
+}
+
+void gpu_timer_t::end_frame() {
+    if (!supported)
+        return;
+
+    frame++;
+
+    // Collect the slot the next frame will reuse
+    const int slot = frame % latency;
+
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+        if (!pending[slot][pass])
+            continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available)
+            continue;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[slot][pass], GL_QUERY_RESULT, &elapsed);
+
+        results[pass] = elapsed / 1e6;
+        pending[slot][pass] = false;
+    }
+}
+
+void gpu_timer_t::debug_info(char *buffer, const size_t &size, size_t &offset) {
+    if (!supported) {
+        util::format_to(buffer, size, offset, "GPU timers unavailable\n");
+        return;
+    }
+
+    util::format_to(buffer, size, offset, "GPU");
+
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++)
+        util::format_to(buffer, size, offset, " {} {:.2f}", pass_names[pass], results[pass]);
+
+    util::format_to(buffer, size, offset, " ms\n");
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <EGL/eglext.h>
+
+#include "headless.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+headless_context_t::headless_context_t():
+        display(EGL_NO_DISPLAY),
+        context(EGL_NO_CONTEXT),
+        surface(EGL_NO_SURFACE),
+        fbo(0),
+        color_rb(0),
+        depth_rb(0),
+        size(0),
+        frame(0) {
+
+}
+
+headless_context_t::~headless_context_t() {
+    destroy();
+}
+
+bool headless_context_t::init(int width, int height) {
+    auto has_extension = [](const char *extensions, const char *name) {
+        return extensions && strstr(extensions, name);
+    };
+
+    const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (get_platform_display && has_extension(client_extensions, "EGL_MESA_platform_surfaceless"))
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        fprintf(stderr, "Failed to initialize EGL display %x\n", eglGetError());
+        return glfail;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "EGL display has no desktop OpenGL\n");
+        return glfail;
+    }
+
+    bool surfaceless = has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+
+    const EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(display, config_attribs, &config, 1, &config_count) || config_count < 1) {
+        fprintf(stderr, "No EGL config for headless rendering %x\n", eglGetError());
+        return glfail;
+    }
+
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+
+    if (context == EGL_NO_CONTEXT) {
+        fprintf(stderr, "Failed to create EGL context %x\n", eglGetError());
+        return glfail;
+    }
+
+    if (!surfaceless) {
+        const EGLint pbuffer_attribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbuffer_attribs);
+
+        if (surface == EGL_NO_SURFACE) {
+            fprintf(stderr, "Failed to create EGL pbuffer %x\n", eglGetError());
+            return glfail;
+        }
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        fprintf(stderr, "Failed to make EGL context current %x\n", eglGetError());
+        return glfail;
+    }
+
+    if (surface != EGL_NO_SURFACE)
+        eglSwapInterval(display, 0);
+
+    glGenRenderbuffers(1, &color_rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_rb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depth_rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_rb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_rb);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_rb);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Headless framebuffer incomplete\n");
+        return glfail;
+    }
+
+    glViewport(0, 0, width, height);
+
+    size = {width, height};
+    default_framebuffer = fbo;
+
+    fprintf(stderr, "Headless EGL %i.%i (%s) %s\n", major, minor, surfaceless ? "surfaceless" : "pbuffer", (const char*)glGetString(GL_RENDERER));
+
+    return glsuccess;
+}
+
+void headless_context_t::destroy() {
+    if (display == EGL_NO_DISPLAY)
+        return;
+
+    if (context != EGL_NO_CONTEXT) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &color_rb);
+        glDeleteRenderbuffers(1, &depth_rb);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+
+    if (surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+
+    eglTerminate(display);
+
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+    surface = EGL_NO_SURFACE;
+    default_framebuffer = 0;
+}
+
+bool headless_context_t::dump_frame(const char *path) {
+    const int row = size.x * 3;
+
+    pixels.resize(row * size.y);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, size.x, size.y, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE *file = fopen(path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    fprintf(file, "P6\n%i %i\n255\n", size.x, size.y);
+
+    // GL rows start at the bottom
+    for (int y = size.y - 1; y >= 0; y--)
+        fwrite(&pixels[y * row], 1, row, file);
+
+    fclose(file);
+
+    return glsuccess;
+}
+
+void headless_context_t::swap() {
+    if (dump_prefix.size() > 0) {
+        char path[512];
+        snprintf(path, sizeof path, "%s%06i.ppm", dump_prefix.c_str(), frame);
+        dump_frame(path);
+    } else {
+        glFlush();
+    }
+
+    frame++;
+}
\ No newline at end of file
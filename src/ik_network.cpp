@@ -0,0 +1,397 @@
+#include <errno.h>
+#include <string.h>
+#include <random>
+#include <numeric>
+
+#include "ik_network.h"
+#include "common.h"
+
+ik_network_t::ik_network_t():
+        weights{} {
+    for (int i = 0; i < inputs; i++) {
+        input_offset[i] = 0.0f;
+        input_scale[i] = 1.0f;
+    }
+
+    for (int i = 0; i < outputs; i++) {
+        output_offset[i] = 0.0f;
+        output_scale[i] = 1.0f;
+    }
+
+    for (int i = 0; i < joints; i++) {
+        min_degrees[i] = -180.0f;
+        max_degrees[i] = 180.0f;
+    }
+}
+
+void ik_network_t::normalize_input(const glm::vec3 &target, const float &pitch, float *input) const {
+    const float raw[inputs] = {target.x, target.y, target.z, pitch};
+
+    for (int i = 0; i < inputs; i++)
+        input[i] = (raw[i] - input_offset[i]) * input_scale[i];
+}
+
+void ik_network_t::predict(const glm::vec3 &target, const float &pitch, float *degrees) const {
+    activations_t a;
+    normalize_input(target, pitch, a.input);
+    forward(a);
+
+    degrees[0] = 0.0f;
+
+    for (int i = 0; i < outputs; i++)
+        degrees[i + 1] = a.output[i] * output_scale[i] + output_offset[i];
+}
+
+float ik_network_t::solve(const glm::vec3 &root, const glm::vec3 &target, const float &pitch, float *degrees, int refine_steps) const {
+    // Damping keeps steps bounded near singular poses, in world units
+    constexpr float damping = 0.5f;
+
+    predict(target - root, pitch, degrees);
+
+    chain_t::pose_t pose;
+    chain_t::jacobian_t jacobian;
+    chain_t::forward(root, degrees, pose);
+
+    for (int step = 0; step < refine_steps; step++) {
+        const glm::vec3 error = target - pose.tip;
+
+        if (glm::dot(error, error) < 1e-6f)
+            break;
+
+        chain_t::jacobian(pose, jacobian);
+
+        // J J^T + damping^2 I, three by three whatever the joint count
+        glm::mat3 jjt(damping * damping);
+
+        for (int j = 1; j < joints; j++)
+            for (int c = 0; c < 3; c++)
+                jjt[c] += jacobian[j] * jacobian[j][c];
+
+        const glm::vec3 y = glm::inverse(jjt) * error;
+
+        for (int j = 1; j < joints; j++)
+            degrees[j] = std::clamp(degrees[j] + glm::degrees(glm::dot(jacobian[j], y)), min_degrees[j], max_degrees[j]);
+
+        chain_t::forward(root, degrees, pose);
+    }
+
+    return glm::length(target - pose.tip);
+}
+
+struct ik_network_header_t {
+    uint32_t magic, version;
+    int32_t inputs, outputs, width, output_stride;
+};
+
+bool ik_network_t::save(const char *path) const {
+    FILE *file = fopen(path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    const ik_network_header_t header = {magic, version, inputs, outputs, width, output_stride};
+
+    bool written =
+        fwrite(&header, sizeof header, 1, file) == 1 &&
+        fwrite(&weights, sizeof weights, 1, file) == 1 &&
+        fwrite(input_offset, sizeof input_offset, 1, file) == 1 &&
+        fwrite(input_scale, sizeof input_scale, 1, file) == 1 &&
+        fwrite(output_offset, sizeof output_offset, 1, file) == 1 &&
+        fwrite(output_scale, sizeof output_scale, 1, file) == 1 &&
+        fwrite(min_degrees, sizeof min_degrees, 1, file) == 1 &&
+        fwrite(max_degrees, sizeof max_degrees, 1, file) == 1;
+
+    fclose(file);
+
+    if (!written) {
+        fprintf(stderr, "Failed to write %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    return glsuccess;
+}
+
+bool ik_network_t::load(const char *path) {
+    FILE *file = fopen(path, "rb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    ik_network_header_t header;
+
+    if (fread(&header, sizeof header, 1, file) != 1 || header.magic != magic) {
+        fprintf(stderr, "Not an IK network: %s\n", path);
+        fclose(file);
+        return glfail;
+    }
+
+    if (header.version != version || header.inputs != inputs || header.outputs != outputs ||
+        header.width != width || header.output_stride != output_stride) {
+        fprintf(stderr, "IK network version %u, %ix%i, expected version %u, %ix%i: %s\n",
+            header.version, header.inputs, header.width, version, inputs, width, path);
+        fclose(file);
+        return glfail;
+    }
+
+    bool read =
+        fread(&weights, sizeof weights, 1, file) == 1 &&
+        fread(input_offset, sizeof input_offset, 1, file) == 1 &&
+        fread(input_scale, sizeof input_scale, 1, file) == 1 &&
+        fread(output_offset, sizeof output_offset, 1, file) == 1 &&
+        fread(output_scale, sizeof output_scale, 1, file) == 1 &&
+        fread(min_degrees, sizeof min_degrees, 1, file) == 1 &&
+        fread(max_degrees, sizeof max_degrees, 1, file) == 1;
+
+    fclose(file);
+
+    if (!read) {
+        fprintf(stderr, "IK network truncated: %s\n", path);
+        return glfail;
+    }
+
+    return glsuccess;
+}
+
+void ik_dataset_t::generate(const float *min_degrees, const float *max_degrees, int count, uint32_t seed) {
+    using chain_t = ik_network_t::chain_t;
+    constexpr int joints = ik_network_t::joints;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::copy_n(min_degrees, joints, this->min_degrees);
+    std::copy_n(max_degrees, joints, this->max_degrees);
+
+    // Elbow up, bent the way the shoulder leans forward
+    this->min_degrees[3] = std::min(std::max(min_degrees[3], 0.0f), max_degrees[3]);
+
+    input.resize(count * inputs);
+    output.resize(count * outputs);
+
+    for (int n = 0; n < count;) {
+        float degrees[joints];
+        degrees[0] = 0.0f;
+
+        for (int i = 1; i < joints; i++)
+            degrees[i] = this->min_degrees[i] + unit(rng) * (this->max_degrees[i] - this->min_degrees[i]);
+
+        chain_t::pose_t pose;
+        chain_t::forward(glm::vec3(0.0f), degrees, pose);
+
+        // Tip in front of the shoulder, turning the base half a turn and reaching back is the same target
+        const glm::vec3 forward = glm::cross(pose.axes[2], glm::vec3(0.0f, 1.0f, 0.0f));
+
+        if (glm::dot(pose.tip - pose.origins[2], forward) < 0.0f)
+            continue;
+
+        float *in = &input[n * inputs];
+        in[0] = pose.tip.x;
+        in[1] = pose.tip.y;
+        in[2] = pose.tip.z;
+        in[3] = ik_network_t::pitch(degrees);
+
+        std::copy_n(degrees + 1, outputs, &output[n * outputs]);
+        n++;
+    }
+}
+
+ik_trainer_t::ik_trainer_t():
+        epochs(40),
+        batch_size(32),
+        learning_rate(0.003f),
+        final_rate(0.05f),
+        seed(1),
+        verbose(true) {
+
+}
+
+float ik_trainer_t::train(ik_network_t &network, const ik_dataset_t &data) const {
+    using weights_t = ik_network_t::weights_t;
+    using activations_t = ik_network_t::activations_t;
+
+    constexpr int inputs = ik_network_t::inputs;
+    constexpr int outputs = ik_network_t::outputs;
+    constexpr int width = ik_network_t::width;
+    constexpr int output_stride = ik_network_t::output_stride;
+    constexpr float beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-8f;
+
+    const int count = data.size();
+
+    if (count < 1)
+        return 0.0f;
+
+    std::mt19937 rng(seed);
+
+    // Inputs to zero mean unit variance
+    for (int i = 0; i < inputs; i++) {
+        double sum = 0.0, square = 0.0;
+
+        for (int n = 0; n < count; n++) {
+            double v = data.input[n * inputs + i];
+            sum += v;
+            square += v * v;
+        }
+
+        double mean = sum / count;
+        double deviation = std::sqrt(std::max(square / count - mean * mean, 1e-12));
+
+        network.input_offset[i] = mean;
+        network.input_scale[i] = 1.0 / deviation;
+    }
+
+    // Outputs to -1..1 over the trained range
+    for (int i = 0; i < outputs; i++) {
+        const float low = data.min_degrees[i + 1], high = data.max_degrees[i + 1];
+
+        network.output_offset[i] = (low + high) * 0.5f;
+        network.output_scale[i] = std::max((high - low) * 0.5f, 1e-3f);
+    }
+
+    std::copy_n(data.min_degrees, ik_network_t::joints, network.min_degrees);
+    std::copy_n(data.max_degrees, ik_network_t::joints, network.max_degrees);
+
+    // Glorot uniform, zero biases and padding
+    auto &w = network.weights;
+    w = {};
+
+    auto init = [&](float *layer, int in, int out, int stride) {
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        const float limit = std::sqrt(6.0f / (in + out));
+
+        for (int i = 0; i < in; i++)
+            for (int o = 0; o < out; o++)
+                layer[i * stride + o] = dist(rng) * limit;
+    };
+
+    init(&w.w0[0][0], inputs, width, width);
+    init(&w.w1[0][0], width, width, width);
+    init(&w.w2[0][0], width, outputs, output_stride);
+
+    // Normalized training set, so batches only gather
+    std::vector<float> in(count * inputs), target(count * outputs);
+
+    for (int n = 0; n < count; n++) {
+        for (int i = 0; i < inputs; i++)
+            in[n * inputs + i] = (data.input[n * inputs + i] - network.input_offset[i]) * network.input_scale[i];
+
+        for (int i = 0; i < outputs; i++)
+            target[n * outputs + i] = (data.output[n * outputs + i] - network.output_offset[i]) / network.output_scale[i];
+    }
+
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+
+    weights_t gradient, m{}, v{};
+    float *params = w.data(), *g = gradient.data(), *mp = m.data(), *vp = v.data();
+    int step = 0;
+    float loss = 0.0f;
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        std::shuffle(order.begin(), order.end(), rng);
+
+        // Exponential decay from learning_rate to learning_rate * final_rate
+        const float progress = epochs > 1 ? float(epoch) / (epochs - 1) : 0.0f;
+        const float rate = learning_rate * std::pow(final_rate, progress);
+        double epoch_loss = 0.0;
+
+        for (int first = 0; first < count; first += batch_size) {
+            const int batch = std::min(batch_size, count - first);
+            gradient = {};
+
+            for (int b = 0; b < batch; b++) {
+                const int n = order[first + b];
+                activations_t a;
+
+                std::copy_n(&in[n * inputs], inputs, a.input);
+                network.forward(a);
+
+                // Backward pass, padded outputs carry no error
+                alignas(32) float d_out[output_stride] = {0};
+                alignas(32) float d_h2[width], d_h1[width];
+
+                for (int o = 0; o < outputs; o++) {
+                    d_out[o] = a.output[o] - target[n * outputs + o];
+                    epoch_loss += d_out[o] * d_out[o];
+                }
+
+                for (int i = 0; i < width; i++) {
+                    float sum = 0.0f;
+
+                    for (int o = 0; o < output_stride; o++) {
+                        gradient.w2[i][o] += a.h2[i] * d_out[o];
+                        sum += w.w2[i][o] * d_out[o];
+                    }
+
+                    d_h2[i] = sum;
+                }
+
+                for (int o = 0; o < output_stride; o++)
+                    gradient.b2[o] += d_out[o];
+
+                // The fused layers keep only activated outputs, the slopes need the sums again
+                alignas(32) float z2[width], z1[width];
+
+                for (int o = 0; o < width; o++)
+                    z1[o] = w.b0[o];
+                for (int i = 0; i < inputs; i++)
+                    for (int o = 0; o < width; o++)
+                        z1[o] += a.input[i] * w.w0[i][o];
+
+                for (int o = 0; o < width; o++)
+                    z2[o] = w.b1[o];
+                for (int i = 0; i < width; i++)
+                    for (int o = 0; o < width; o++)
+                        z2[o] += a.h1[i] * w.w1[i][o];
+
+                for (int o = 0; o < width; o++)
+                    d_h2[o] *= ik_network_t::activation_slope(z2[o]);
+
+                for (int i = 0; i < width; i++) {
+                    float sum = 0.0f;
+
+                    for (int o = 0; o < width; o++) {
+                        gradient.w1[i][o] += a.h1[i] * d_h2[o];
+                        sum += w.w1[i][o] * d_h2[o];
+                    }
+
+                    d_h1[i] = sum * ik_network_t::activation_slope(z1[i]);
+                }
+
+                for (int o = 0; o < width; o++)
+                    gradient.b1[o] += d_h2[o];
+
+                for (int i = 0; i < inputs; i++)
+                    for (int o = 0; o < width; o++)
+                        gradient.w0[i][o] += a.input[i] * d_h1[o];
+
+                for (int o = 0; o < width; o++)
+                    gradient.b0[o] += d_h1[o];
+            }
+
+            step++;
+
+            const float scale = 1.0f / batch;
+            const float correct1 = 1.0f / (1.0f - std::pow(beta1, step));
+            const float correct2 = 1.0f / (1.0f - std::pow(beta2, step));
+
+            for (int i = 0; i < ik_network_t::weight_count; i++) {
+                const float grad = g[i] * scale;
+
+                mp[i] = beta1 * mp[i] + (1.0f - beta1) * grad;
+                vp[i] = beta2 * vp[i] + (1.0f - beta2) * grad * grad;
+                params[i] -= rate * (mp[i] * correct1) / (std::sqrt(vp[i] * correct2) + epsilon);
+            }
+        }
+
+        loss = epoch_loss / (double(count) * outputs);
+
+        if (verbose)
+            fprintf(stderr, "IK network epoch %i/%i, loss %g, learning rate %g\n", epoch + 1, epochs, loss, rate);
+    }
+
+    return loss;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include <errno.h>
+#include <stddef.h>
+
+#include "input_record.h"
+
+input_record_t::input_record_t():
+        file(nullptr),
+        header{0},
+        playback(false),
+        frame(0),
+        tick(0),
+        press_count(0) {
+
+}
+
+input_record_t::~input_record_t() {
+    close();
+}
+
+bool input_record_t::open_record(const char *path, double tick_rate) {
+    file = fopen(path, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    playback = false;
+    header = {magic, version, tick_rate, 0, 0};
+
+    // Counts are filled in on close
+    if (fwrite(&header, sizeof header, 1, file) != 1) {
+        fprintf(stderr, "Failed to write %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    return glsuccess;
+}
+
+bool input_record_t::open_playback(const char *path) {
+    file = fopen(path, "rb");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    playback = true;
+
+    if (fread(&header, sizeof header, 1, file) != 1 || header.magic != magic) {
+        fprintf(stderr, "Not an input recording: %s\n", path);
+        return glfail;
+    }
+
+    if (header.version != version) {
+        fprintf(stderr, "Input recording version %u, expected %u: %s\n", header.version, version, path);
+        return glfail;
+    }
+
+    if (header.frames < 1) {
+        fprintf(stderr, "Input recording has no frames, was it closed? %s\n", path);
+        return glfail;
+    }
+
+    return glsuccess;
+}
+
+void input_record_t::close() {
+    if (!file)
+        return;
+
+    if (!playback) {
+        header.frames = frame;
+        header.ticks = tick;
+        fseek(file, 0, SEEK_SET);
+        fwrite(&header, sizeof header, 1, file);
+
+        fprintf(stderr, "Recorded %lu frames, %lu ticks of input\n", (unsigned long)frame, (unsigned long)tick);
+    }
+
+    fclose(file);
+    file = nullptr;
+}
+
+bool input_record_t::begin_frame(double &delta_time) {
+    if (!file)
+        return false;
+
+    if (!playback) {
+        uint8_t chunk = CHUNK_FRAME;
+        fwrite(&chunk, 1, 1, file);
+        fwrite(&delta_time, sizeof delta_time, 1, file);
+        frame++;
+        return true;
+    }
+
+    // Skip ticks the previous frame recorded but did not run
+    int chunk;
+    while ((chunk = fgetc(file)) == CHUNK_TICK) {
+        input_tick_t skipped;
+        ungetc(chunk, file);
+        if (!sync_tick(skipped))
+            return false;
+    }
+
+    if (chunk != CHUNK_FRAME || fread(&delta_time, sizeof delta_time, 1, file) != 1)
+        return false;
+
+    frame++;
+    return true;
+}
+
+void input_record_t::press(int key) {
+    if (!file || playback)
+        return;
+
+    if (press_count >= input_tick_t::press_slots) {
+        fprintf(stderr, "Too many key presses in one tick, dropped key %i\n", key);
+        return;
+    }
+
+    presses[press_count++] = key;
+}
+
+bool input_record_t::sync_tick(input_tick_t &in) {
+    if (!file)
+        return false;
+
+    const size_t fixed = offsetof(input_tick_t, pads);
+
+    if (!playback) {
+        in.press_count = press_count;
+        memcpy(&in.presses[0], &presses[0], sizeof presses);
+        press_count = 0;
+
+        uint8_t chunk = CHUNK_TICK;
+        fwrite(&chunk, 1, 1, file);
+        fwrite(&in, fixed, 1, file);
+        fwrite(&in.pads[0], sizeof in.pads[0], in.pad_count, file);
+        tick++;
+        return true;
+    }
+
+    // A frame that runs more ticks than recorded keeps the last state
+    int chunk = fgetc(file);
+    if (chunk != CHUNK_TICK) {
+        ungetc(chunk, file);
+        return false;
+    }
+
+    if (fread(&in, fixed, 1, file) != 1 || in.pad_count > input_tick_t::pad_slots ||
+        in.press_count > input_tick_t::press_slots ||
+        fread(&in.pads[0], sizeof in.pads[0], in.pad_count, file) != in.pad_count) {
+        in.pad_count = in.press_count = 0;
+        return false;
+    }
+
+    tick++;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,376 @@
+#include <cmath>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "kinematics.h"
+#include "mesh.h"
+#include "ik_network.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "util.h"
+
+kinematics_t::kinematics_t(robot_chain_t *chain, int validate_threads):
+        chain(chain),
+        validator(validate_threads),
+        network(nullptr),
+        benchmark(nullptr),
+        collision_checking(true) {
+
+}
+
+bool kinematics_t::solve_network(const vec3_d &target, std::vector<float> &rot_out) {
+    PROFILE_SCOPE("solve_network");
+
+    auto &segments = chain->ik;
+    float degrees[ik_network_t::joints];
+
+    for (int i = 0; i < ik_network_t::joints; i++)
+        degrees[i] = segments[i]->get_rotation(false);
+
+    float error = network->solve(segments[0]->get_origin(false), glm::vec3(target), ik_network_t::pitch(degrees), degrees);
+
+    if (debug_pedantic)
+        printf("Network solution ends %.3f from the target\n", error);
+
+    if (error > network_tolerance)
+        return glfail;
+
+    std::copy_n(degrees + 1, ik_network_t::joints - 1, rot_out.begin() + 1);
+
+    return glsuccess;
+}
+
+bool kinematics_t::solve_inverse(vec3_d coordsIn) {
+    PROFILE_SCOPE("solve_inverse");
+
+    if (benchmark)
+        benchmark->count(gui::COUNT_IK_SOLVES);
+
+    auto isnot_real = [](float x){
+        return (std::isinf(x) || std::isnan(x));
+    };
+
+    // Root, base yaw joint, then the planar joints
+    auto &segments = chain->ik;
+
+    bool calculation_failure = false;
+
+    auto target_coords = coordsIn;
+    target_coords.z = -target_coords.z;
+    auto target_2d = glm::vec2(target_coords.x, target_coords.z);
+
+    std::vector<float> rot_out(segments.size());
+
+    for (int i = 0; i < segments.size(); i++)
+        rot_out[i] = segments[i]->get_clamped_rotation(false);
+
+    glm::vec3 seg_6, seg_5;
+
+    if (chain->fixed_xarm) {
+        xarm_chain_t::pose_t pose;
+        xarm_chain_t::forward(segments, false, pose);
+        seg_6 = pose.origins[1];
+        seg_5 = pose.origins[2];
+    } else {
+        seg_6 = segments[1]->get_origin(false);
+        seg_5 = segments[2]->get_origin(false);
+    }
+
+    // solve base rotation
+    auto seg2d_6 = glm::vec2(seg_6.x, seg_6.z);
+
+    auto dif_6 = target_2d - seg2d_6;
+    auto atan2_6 = atan2(dif_6[1], dif_6[0]);
+    auto norm_6 = atan2_6 / M_PI;
+    auto rot_6 = (norm_6 + 1.0f) / 2.0f;
+    auto deg_6 = rot_6 * 360.0f;
+    auto serv_6 = rot_6;
+
+    glm::vec3 seg_5_real = glm::vec3(seg_5.x, seg_5.z, seg_5.y);
+    glm::vec3 target_for_calc = target_coords;
+
+    auto target_pl3d = util::map_to_xy<float>(target_for_calc, deg_6, glm::vec3(y_axis), seg_5);
+    auto target_pl2d = glm::vec2(target_pl3d.x, target_pl3d.y);
+    auto plo3d = glm::vec3(0.0f);
+    auto plo2d = glm::vec2(0.0f);
+    //auto pl3d = glm::vec3(500.0f, 0.0f, 0.0f);
+    //auto pl2d = glm::vec2(pl3d);
+    //auto s2d = glm::vec2(500);
+
+    std::vector<segment_t*> remaining_segments;
+    remaining_segments.assign(segments.begin() + 2, segments.end());
+
+    glm::vec2 prev_origin = target_pl2d;
+    std::vector<glm::vec2> new_origins;
+ 
+    if (debug_pedantic)
+        printf("target_pl2d <%.2f,%.2f> target_pl3d <%.2f,%.2f,%.2f> target_real <%.2f,%.2f,%.2f> seg_5 <%.2f,%.2f,%.2f> deg_6: %.2f\n", target_pl2d.x, target_pl2d.y, target_pl3d.x, target_pl3d.y, target_pl3d.z, target_coords.x, target_coords.y, target_coords.z, seg_5.x, seg_5.y, seg_5.z, deg_6);
+
+    while (true) {
+        if (remaining_segments.size() < 1) {
+            if (debug_pedantic)
+                puts("No more segments");
+            break;
+        }
+
+        auto seg = remaining_segments.back();
+        float segment_radius = seg->get_length();
+        float total_length = 0.0f;
+
+        for (auto *x : remaining_segments)
+            total_length += x->get_length();
+
+        float dist_to_segment = total_length - segment_radius;
+        float segment_min = total_length - (segment_radius * 2);
+        float dist_origin_to_prev = glm::distance<2, float>(plo2d, prev_origin);
+        glm::vec2 mag = glm::normalize(prev_origin - plo2d);
+        
+        seg->debug_color = {0.,1.,0};
+        bool skip_optim = false;
+
+        if (remaining_segments.size() < 3) {
+            if (debug_pedantic)
+                puts("2 or less segments left");
+            skip_optim = true;
+        }
+
+        float equal_mp = ((dist_origin_to_prev * dist_origin_to_prev) -
+                    (segment_radius * segment_radius) +
+                    (dist_to_segment * dist_to_segment)) /
+                    (2 * dist_origin_to_prev);
+
+        float rem_dist = dist_origin_to_prev - equal_mp;
+        float rem_min = -segment_radius/2.0f;
+        float rem_retract = 0.0f;
+        float rem_extend = segment_radius * 0.5f;
+        float rem_ex2 = rem_extend * 1.75f;
+        float rem_max = segment_radius * 0.95f;
+
+        if (debug_pedantic)
+            printf("servo: %i, rem_dist: %.2f, rem_max: %.2f, equal_mp: %.2f, segment_radius: %.2f, dist_origin_to_prev: %.2f, dist_to_segment: %.2f, total_length: %.2f, prev_origin <%.2f,%.2f>\n", seg->servo_num, rem_dist, rem_max, equal_mp, segment_radius, dist_origin_to_prev, dist_to_segment, total_length, prev_origin.x, prev_origin.y);
+
+        auto new_origin = prev_origin;
+
+        if (dist_to_segment < 0.05f) {
+            new_origins.push_back(new_origin);
+            if (debug_pedantic)
+                puts("Convergence");
+            break;
+        }
+
+        if (rem_dist > rem_max) {
+            if (debug_pedantic) {
+                puts("Not enough overlap");
+                printf("rem_dist: %.2f rem_max: %.2f\n", rem_dist, rem_max);
+                seg->debug_color = {0.,0.,0.};
+            }
+        }
+
+        if (!skip_optim) {
+            if (segment_radius > dist_origin_to_prev) {
+                auto v = rem_extend - (segment_radius - dist_origin_to_prev);
+                equal_mp = dist_origin_to_prev - v;
+                if (debug_pedantic) {
+                    seg->debug_color = {1.,0,0};
+                    puts("Too close to origin");
+                }
+            } else
+            if (rem_dist < rem_extend && total_length > dist_origin_to_prev) {
+                equal_mp = dist_origin_to_prev - rem_extend;
+                if (debug_pedantic) {
+                    seg->debug_color = {1.,1,1};
+                    puts("Maintain center of gravity");
+                }
+            } else
+            if (rem_dist < rem_retract && total_length > dist_origin_to_prev) {
+                equal_mp = dist_origin_to_prev - rem_retract;
+                if (debug_pedantic) {
+                    puts("Too much leftover length");
+                    seg->debug_color = {1.,.5,.5};
+                }
+            } else
+            if (rem_dist < rem_ex2 && rem_dist >= rem_extend && total_length > dist_origin_to_prev) {
+                if (debug_pedantic) {
+                    puts("Too much leftover length");
+                    seg->debug_color = {0.,.5,.5};
+                }
+                auto r = rem_ex2 - rem_extend;
+                r = (rem_dist - rem_extend) / r;
+                auto v = r / 2.0f;
+
+                if (v > 0.4f)
+                    v -= (v - 0.38f);
+
+                equal_mp = dist_origin_to_prev - (v * segment_radius + rem_extend);
+            }
+
+            if (rem_dist < rem_min) {
+                if (debug_pedantic)
+                    puts("Too much overlap");
+                    seg->debug_color = {0.25,0.25,0.25};
+                rem_dist = rem_min;
+            } else
+            if (rem_dist > rem_max) {
+                if (debug_pedantic)
+                    puts("Not enough overlap");
+                    seg->debug_color = {0,0,0.};
+            } else {
+                rem_dist = dist_origin_to_prev - equal_mp;
+            }
+        }
+
+        if (debug_pedantic)
+            printf("rem_dist: %.2f, rem_max: %.2f, equal_mp: %.2f, dist_origin_to_prev: %.2f, dist_to_segment: %.2f\n", rem_dist, rem_max, equal_mp, dist_origin_to_prev, dist_to_segment);
+
+        auto mp_vec = mag * equal_mp;
+        //auto n = sqrtf((segment_radius - rem_dist) * (segment_radius - rem_dist));
+        auto n = sqrtf(abs((segment_radius * segment_radius) - (rem_dist * rem_dist)));
+        auto o = atan2(mag.y, mag.x) - (M_PI / 2.0f);
+        auto new_mag = glm::normalize(glm::vec2(cosf(o),sinf(o)));
+        new_origin = mp_vec + (new_mag * n);
+        auto new_origin3d = glm::vec3(new_origin.x, new_origin.y, 0.0f);
+        auto dist_new_prev = glm::distance<2, float>(new_origin, prev_origin);
+
+        if (debug_pedantic)
+            printf("mp_vec <%.2f %.2f>, segment_radius: %.2f, rem_dist: %.2f, n: %.2f, o: %.2f, new_mag <%.2f,%.2f>, dist_new_prev: %.2f\n", mp_vec[0], mp_vec[1], segment_radius, rem_dist, n, o, new_mag[0], new_mag[1], dist_new_prev);
+
+        if (calculation_failure)
+            seg->debug_color = {1.0,0,0};
+
+        float tolerable_distance = 10.0f;
+
+        if (abs(dist_new_prev - segment_radius) > tolerable_distance) {
+            if (debug_pedantic)
+                puts("Distance to prev is too different");
+            calculation_failure = true;
+        }
+
+        if (remaining_segments.size() < 1 && glm::distance<2, float>(new_origin, target_pl2d) > tolerable_distance) {
+            if (debug_pedantic)
+                puts("Distance to target is too far");
+            calculation_failure = true;
+        }
+
+        //if (isnot_real(new_origin.x) || isnot_real(new_origin.y))
+        //    new_origin = prev_origin;//glm::vec2(0.0f);
+
+        nocalc:;
+
+        prev_origin = new_origin;
+        new_origins.push_back(new_origin);
+        remaining_segments.pop_back();
+    }
+
+    // The network covers what the geometric solution cannot reach
+    bool network_solved = calculation_failure && network && chain->fixed_xarm && !solve_network(coordsIn, rot_out);
+
+    if (calculation_failure && !network_solved) {
+        if (debug_pedantic)
+            puts("Failed to calculate");
+        return glfail;
+    } else if (!network_solved) {
+        if (new_origins.size() < 1) {
+            if (debug_pedantic)
+                puts("Not enough origins");
+            return glfail;
+        }
+
+        float prevrot = 0.0f;
+        auto prevmag = glm::vec2(0.0f,1.0f);
+        auto prev = glm::vec2(0.0f);
+        new_origins.pop_back();
+        std::reverse(new_origins.begin(), new_origins.end());
+        new_origins.push_back(target_pl2d);
+
+        for (int i = 0; i < new_origins.size(); i++) {
+            auto cur = new_origins[i];
+
+            auto dif = cur - prev;
+            auto mag = glm::normalize(dif);
+
+            auto servo = segments[i + 2];
+            auto calcmag = mag;
+
+            auto rot = atan2(calcmag.x, calcmag.y) - prevrot;
+
+            auto deg = ((glm::degrees(rot)) / 180.0f) * 0.5f + 1.0f;
+            deg *= 360;
+
+            if (isnot_real(deg)) {
+                deg = rot_out[i + 2];
+                rot = glm::radians(deg);
+            }
+            
+            if (debug_pedantic)
+                printf("servo: %i, rot: %.2f, deg: %.2f, prevrot: %.2f, calcmag[0]: %.2f, calcmag[1]: %.2f, cur[0]: %.2f, cur[1]: %.2f, prev[0]: %.2f, prev[1]: %.2f\n", servo->servo_num, rot, deg, prevrot, calcmag.x, calcmag.y, cur.x, cur.y, prev.x, prev.y);
+
+            
+            rot_out[i + 2] = deg;
+
+            prev = cur;
+            prevmag = mag;
+            prevrot = prevrot + rot;
+        }
+    }
+
+    auto print_rot = [&](const char *label) {
+        printf("%s rot:", label);
+        for (int i = 0; i < rot_out.size(); i++)
+            printf("%c%.2f", i ? ',' : ' ', rot_out[i]);
+        puts("");
+    };
+
+    if (debug_pedantic)
+        print_rot("Initial");
+
+    if (!network_solved)
+        rot_out[1] = serv_6 * 360;
+
+    if (debug_pedantic)
+        print_rot("End");
+
+    // Kept to undo a solution that collides
+    auto &st = chain->state;
+    int prev_end[chain_state_t::capacity], prev_cur[chain_state_t::capacity];
+    segment_t::tp prev_command[chain_state_t::capacity];
+
+    std::copy_n(st.servo_end_position, st.count, prev_end);
+    std::copy_n(st.servo_cur_position, st.count, prev_cur);
+    std::copy_n(st.last_command, st.count, prev_command);
+
+    for (int i = 0; i < segments.size(); i++) {
+        auto wrapped = util::wrap(rot_out[i], -180, 180);
+        segments[i]->set_rotation_bound(wrapped);
+    }
+
+    // Whole move from where the arm is now, not only where it ends
+    collision_contact_t contact;
+    float hit_time = collision_checking ? validator.validate(*chain, trajectory_t(*chain), &contact) : -1.0f;
+
+    if (hit_time >= 0.0f) {
+        std::copy_n(prev_end, st.count, st.servo_end_position);
+        std::copy_n(prev_cur, st.count, st.servo_cur_position);
+        std::copy_n(prev_command, st.count, st.last_command);
+
+        if (benchmark)
+            benchmark->count(gui::COUNT_COLLISIONS);
+
+        if (debug_mode) {
+            chain->visible[contact.a]->debug_color = {1.0, 0, 0};
+            if (contact.b >= 0)
+                chain->visible[contact.b]->debug_color = {1.0, 0, 0};
+        }
+
+        if (debug_pedantic)
+            printf("Solution collides %.3fs into the move, segment %i with %s %i\n", hit_time, contact.a,
+                contact.b >= 0 ? "segment" : contact.b == collision_contact_t::FLOOR ? "floor" : "box",
+                contact.b >= 0 ? contact.b : collision_contact_t::BOX - contact.b);
+
+        return glfail;
+    }
+
+    if (solved_callback)
+        solved_callback(this);
+
+    return glsuccess;
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <iomanip>
 #include <thread>
-#include <mutex>
+#include <bitset>
+#include <atomic>
 
 #include <signal.h>
 
@@ -12,7 +13,7 @@
 
 #include <hidapi/hidapi.h>
 
-#include "common.h"
+#include "app.h"
 #include "camera.h"
 #include "texture.h"
 #include "mesh.h"
@@ -23,41 +24,77 @@
 #include "ui_text.h"
 #include "ui_slider.h"
 #include "ui_toggle.h"
+#include "ui_batch.h"
+#include "ui_cache.h"
 #include "frametime.h"
+#include "gui.h"
 #include "util.h"
 #include "segment.h"
+#include "file_watch.h"
+#include "debug_draw.h"
+#include "headless.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "gpu_timer.h"
+#include "input_record.h"
+#include "robot_description.h"
+#include "trajectory.h"
+#include "ik_network.h"
+#include "kinematics.h"
+#include "robot_interface.h"
 
 struct shader_text_t;
 struct shader_materials_t;
-struct kinematics_t;
-struct debug_object_t;
 struct debug_info_t;
 struct joystick_t;
-struct robot_interface_t;
+struct robot_instance_t;
 
 texture_t *textTexture, *mainTexture;
 shader_t *mainVertexShader, *mainFragmentShader;
 shader_t *textVertexShader, *textFragmentShader;
+shader_t *debugVertexShader, *debugFragmentShader;
 shader_text_t *textProgram;
 shader_materials_t *mainProgram;
+shader_program_t *debugProgram;
 material_t *robotMaterial;
 camera_t *camera;
-segment_t *sBase, *s6, *s5, *s4, *s3, *s2, *s1;
-std::vector<segment_t*> segments;
+robot_description_t *robot_description;
+robot_chain_t *robot_chain;
+const char *robot_path = "assets/xarm.robot";
+std::vector<robot_instance_t*> robots;
+std::vector<std::wstring> robot_serials;
 std::vector<segment_t*> visible_segments;
-std::vector<segment_t*> servo_segments;
-std::vector<mesh_t*> meshes;
-debug_object_t *debug_objects;
+int active_robot = 0;
+float robot_spacing = 500.0f;
+debug_draw_t *debug_objects;
 ui_text_t *debugInfo;
 ui_toggle_t *debugToggle, *interpolatedToggle, *resetToggle, *resetConnectionToggle, *pedanticToggle;
-ui_slider_t *slider6, *slider5, *slider4, *slider3, *slider2, *slider1, *slider_ambient, *slider_diffuse, *slider_specular, *slider_shininess;
+ui_slider_t *slider_ambient, *slider_diffuse, *slider_specular, *slider_shininess;
 std::vector<ui_slider_t*> slider_whatever;
 std::vector<ui_slider_t*> servo_sliders;
 ui_element_t *uiHandler, *ui_servo_sliders;
+ui_batch_t *ui_batcher;
+ui_cache_t *ui_cache;
 kinematics_t *kinematics;
 joystick_t *joysticks;
 robot_interface_t *robot_interface;
 gui::frametime_t frametime;
+file_watch_t *file_watcher;
+gpu_timer_t *gpu_timer;
+headless_context_t *headless_context;
+long frame_limit = 0;
+const char *frame_dump_prefix = nullptr;
+gui::benchmark_t *benchmark;
+const char *trace_path = nullptr;
+bool redraw_requested = true;
+gui::events::InputDispatcher *input;
+const char *benchmark_path = "benchmark.json";
+input_record_t *input_record;
+bool collision_checking = true;
+ik_network_t *ik_network;
+const char *ik_network_path = nullptr;
+const char *ik_train_path = nullptr;
+int ik_benchmark_count = 0;
 
 struct shader_materials_t : public shader_program_t {
     shader_materials_t(shader_program_t prg)
@@ -120,79 +157,17 @@ struct shader_text_t : public shader_program_t {
     }
 };
 
-struct debug_object_t : public mesh_t {
-    std::vector<std::pair<glm::vec3, glm::vec3>> _lines;
-    std::vector<std::pair<glm::vec3, float>> _spheres;
-
-    void add_line(glm::vec3 origin, glm::vec3 end) {
-        _lines.push_back({origin, end});
-    }
-
-    void add_sphere(glm::vec3 origin, float radius) {
-        _spheres.push_back({origin, radius});
-    }
-
-    void clear() override {
-        _lines.clear();
-        _spheres.clear();
-
-        mesh_t::clear();
-    }
-
-    void render() override {
-        mainProgram->use();
-        mainProgram->set_camera(camera, glm::mat4(1.0f));
-
-        modified = true;
-        mesh_t::render();
-
-        glBegin(GL_LINES);
-        for (auto &l : _lines) {
-            glVertex3f(l.first.x, l.first.y, l.first.z);
-            glVertex3f(l.second.x, l.second.y, l.second.z);
-        }
-        glEnd();
-
-        glBegin(GL_QUADS);
-        for (auto &s : _spheres) {
-            glm::vec3 ws = s.first;
-            float r = s.second * 5;
-            glm::vec3 cr = camera->right * glm::vec3(0.5f) * r;
-            glm::vec3 cu = camera->up * glm::vec3(0.5f) * r;
-            glm::vec3 v1 = ws + cr + cu,
-                      v2 = ws + cr - cu, 
-                      v3 = ws - cr - cu, 
-                      v4 = ws - cr + cu;
-
-            auto glv = [](glm::vec3 p) {
-                glVertex3f(p.x, p.y, p.z);
-            };
-
-            glv(v1);
-            glv(v2);
-            glv(v3);
-            glv(v4);
-        }
-        glEnd();
-
-        this->clear();
-    }    
-};
-
 namespace render {
-    void render_vector(debug_object_t *debug_objects, glm::vec3 origin, glm::vec3 end) {
+    void render_vector(debug_draw_t *debug_objects, glm::vec3 origin, glm::vec3 end) {
         debug_objects->add_line(origin, end);
     }
 
-    void render_matrix(debug_object_t *debug_objects, glm::vec3 origin, glm::mat4 mat) {
-        auto m = glm::vec4(origin[0], origin[1], origin[2], 0);
-
-        for (int i  = 0; i < 3; i++)
-            render_vector(debug_objects, origin, m + mat[i]);
+    void render_matrix(debug_draw_t *debug_objects, glm::vec3 origin, glm::mat4 mat) {
+        debug_objects->add_axes(origin, mat);
     }
 
     template<typename T = segment_t>
-    void render_segment_debug(const T* segment, debug_object_t *debug_objects, const bool &allow_interpolate = true) {
+    void render_segment_debug(const T* segment, debug_draw_t *debug_objects, const bool &allow_interpolate = true) {
         auto origin = segment->get_origin(allow_interpolate);
         auto seg_vec = segment->get_segment_vector(allow_interpolate);
         auto rot_mat = segment->get_rotation_matrix(allow_interpolate);
@@ -221,401 +196,104 @@ namespace render {
 
     template<typename T = segment_t>
     void render_segments(const std::vector<T*> &segments, shader_program_t *program, camera_t *camera, const bool &allow_interpolate = true) {
+        PROFILE_SCOPE("render_segments");
+
         program->use();
         for (T* segment : segments)
             render_segment(segment, program, camera, allow_interpolate);
     }
 }
 
-struct kinematics_t {
-    bool solve_inverse(vec3_d coordsIn) {
-        auto isnot_real = [](float x){
-            return (std::isinf(x) || std::isnan(x));
-        };
-
-        auto &segments = visible_segments;
-
-        bool calculation_failure = false;
-
-        auto target_coords = coordsIn;
-        target_coords.z = -target_coords.z;
-        auto target_2d = glm::vec2(target_coords.x, target_coords.z);
-
-        float rot_out[5];
-
-        for (int i = 0; i < segments.size(); i++)
-            rot_out[i] = segments[i]->get_clamped_rotation(false);
-
-        // solve base rotation
-        auto seg_6 = s6->get_origin(false);
-        auto seg2d_6 = glm::vec2(seg_6.x, seg_6.z);
-
-        auto dif_6 = target_2d - seg2d_6;
-        auto atan2_6 = atan2(dif_6[1], dif_6[0]);
-        auto norm_6 = atan2_6 / M_PI;
-        auto rot_6 = (norm_6 + 1.0f) / 2.0f;
-        auto deg_6 = rot_6 * 360.0f;
-        auto serv_6 = rot_6;
-
-        glm::vec3 seg_5 = s5->get_origin(false);
-        glm::vec3 seg_5_real = glm::vec3(seg_5.x, seg_5.z, seg_5.y);
-        glm::vec3 target_for_calc = target_coords;
-
-        auto target_pl3d = util::map_to_xy<float>(target_for_calc, deg_6, glm::vec3(y_axis), seg_5);
-        auto target_pl2d = glm::vec2(target_pl3d.x, target_pl3d.y);
-        auto plo3d = glm::vec3(0.0f);
-        auto plo2d = glm::vec2(0.0f);
-        //auto pl3d = glm::vec3(500.0f, 0.0f, 0.0f);
-        //auto pl2d = glm::vec2(pl3d);
-        //auto s2d = glm::vec2(500);
-
-        std::vector<segment_t*> remaining_segments;
-        remaining_segments.assign(segments.begin() + 2, segments.end());
-
-        glm::vec2 prev_origin = target_pl2d;
-        std::vector<glm::vec2> new_origins;
- 
-        if (debug_pedantic)
-            printf("target_pl2d <%.2f,%.2f> target_pl3d <%.2f,%.2f,%.2f> target_real <%.2f,%.2f,%.2f> seg_5 <%.2f,%.2f,%.2f> deg_6: %.2f\n", target_pl2d.x, target_pl2d.y, target_pl3d.x, target_pl3d.y, target_pl3d.z, target_coords.x, target_coords.y, target_coords.z, seg_5.x, seg_5.y, seg_5.z, deg_6);
-
-        while (true) {
-            if (remaining_segments.size() < 1) {
-                if (debug_pedantic)
-                    puts("No more segments");
-                break;
-            }
-
-            auto seg = remaining_segments.back();
-            float segment_radius = seg->get_length();
-            float total_length = 0.0f;
-
-            for (auto *x : remaining_segments)
-                total_length += x->get_length();
-
-            float dist_to_segment = total_length - segment_radius;
-            float segment_min = total_length - (segment_radius * 2);
-            float dist_origin_to_prev = glm::distance<2, float>(plo2d, prev_origin);
-            glm::vec2 mag = glm::normalize(prev_origin - plo2d);
-            
-            seg->debug_color = {0.,1.,0};
-            bool skip_optim = false;
-
-            if (remaining_segments.size() < 3) {
-                if (debug_pedantic)
-                    puts("2 or less segments left");
-                skip_optim = true;
-            }
-
-            float equal_mp = ((dist_origin_to_prev * dist_origin_to_prev) -
-                        (segment_radius * segment_radius) +
-                        (dist_to_segment * dist_to_segment)) /
-                        (2 * dist_origin_to_prev);
-
-            float rem_dist = dist_origin_to_prev - equal_mp;
-            float rem_min = -segment_radius/2.0f;
-            float rem_retract = 0.0f;
-            float rem_extend = segment_radius * 0.5f;
-            float rem_ex2 = rem_extend * 1.75f;
-            float rem_max = segment_radius * 0.95f;
-
-            if (debug_pedantic)
-                printf("servo: %i, rem_dist: %.2f, rem_max: %.2f, equal_mp: %.2f, segment_radius: %.2f, dist_origin_to_prev: %.2f, dist_to_segment: %.2f, total_length: %.2f, prev_origin <%.2f,%.2f>\n", seg->servo_num, rem_dist, rem_max, equal_mp, segment_radius, dist_origin_to_prev, dist_to_segment, total_length, prev_origin.x, prev_origin.y);
-
-            auto new_origin = prev_origin;
-
-            if (dist_to_segment < 0.05f) {
-                new_origins.push_back(new_origin);
-                if (debug_pedantic)
-                    puts("Convergence");
-                break;
-            }
-
-            if (rem_dist > rem_max) {
-                if (debug_pedantic) {
-                    puts("Not enough overlap");
-                    printf("rem_dist: %.2f rem_max: %.2f\n", rem_dist, rem_max);
-                    seg->debug_color = {0.,0.,0.};
-                }
-            }
-
-            if (!skip_optim) {
-                if (segment_radius > dist_origin_to_prev) {
-                    auto v = rem_extend - (segment_radius - dist_origin_to_prev);
-                    equal_mp = dist_origin_to_prev - v;
-                    if (debug_pedantic) {
-                        seg->debug_color = {1.,0,0};
-                        puts("Too close to origin");
-                    }
-                } else
-                if (rem_dist < rem_extend && total_length > dist_origin_to_prev) {
-                    equal_mp = dist_origin_to_prev - rem_extend;
-                    if (debug_pedantic) {
-                        seg->debug_color = {1.,1,1};
-                        puts("Maintain center of gravity");
-                    }
-                } else
-                if (rem_dist < rem_retract && total_length > dist_origin_to_prev) {
-                    equal_mp = dist_origin_to_prev - rem_retract;
-                    if (debug_pedantic) {
-                        puts("Too much leftover length");
-                        seg->debug_color = {1.,.5,.5};
-                    }
-                } else
-                if (rem_dist < rem_ex2 && rem_dist >= rem_extend && total_length > dist_origin_to_prev) {
-                    if (debug_pedantic) {
-                        puts("Too much leftover length");
-                        seg->debug_color = {0.,.5,.5};
-                    }
-                    auto r = rem_ex2 - rem_extend;
-                    r = (rem_dist - rem_extend) / r;
-                    auto v = r / 2.0f;
-
-                    if (v > 0.4f)
-                        v -= (v - 0.38f);
-
-                    equal_mp = dist_origin_to_prev - (v * segment_radius + rem_extend);
-                }
-
-                if (rem_dist < rem_min) {
-                    if (debug_pedantic)
-                        puts("Too much overlap");
-                        seg->debug_color = {0.25,0.25,0.25};
-                    rem_dist = rem_min;
-                } else
-                if (rem_dist > rem_max) {
-                    if (debug_pedantic)
-                        puts("Not enough overlap");
-                        seg->debug_color = {0,0,0.};
-                } else {
-                    rem_dist = dist_origin_to_prev - equal_mp;
-                }
-            }
-
-            if (debug_pedantic)
-                printf("rem_dist: %.2f, rem_max: %.2f, equal_mp: %.2f, dist_origin_to_prev: %.2f, dist_to_segment: %.2f\n", rem_dist, rem_max, equal_mp, dist_origin_to_prev, dist_to_segment);
-
-            auto mp_vec = mag * equal_mp;
-            //auto n = sqrtf((segment_radius - rem_dist) * (segment_radius - rem_dist));
-            auto n = sqrtf(abs((segment_radius * segment_radius) - (rem_dist * rem_dist)));
-            auto o = atan2(mag.y, mag.x) - (M_PI / 2.0f);
-            auto new_mag = glm::normalize(glm::vec2(cosf(o),sinf(o)));
-            new_origin = mp_vec + (new_mag * n);
-            auto new_origin3d = glm::vec3(new_origin.x, new_origin.y, 0.0f);
-            auto dist_new_prev = glm::distance<2, float>(new_origin, prev_origin);
-
-            if (debug_pedantic)
-                printf("mp_vec <%.2f %.2f>, segment_radius: %.2f, rem_dist: %.2f, n: %.2f, o: %.2f, new_mag <%.2f,%.2f>, dist_new_prev: %.2f\n", mp_vec[0], mp_vec[1], segment_radius, rem_dist, n, o, new_mag[0], new_mag[1], dist_new_prev);
-
-            if (calculation_failure)
-                seg->debug_color = {1.0,0,0};
-
-            float tolerable_distance = 10.0f;
-
-            if (abs(dist_new_prev - segment_radius) > tolerable_distance) {
-                if (debug_pedantic)
-                    puts("Distance to prev is too different");
-                calculation_failure = true;
-            }
-
-            if (remaining_segments.size() < 1 && glm::distance<2, float>(new_origin, target_pl2d) > tolerable_distance) {
-                if (debug_pedantic)
-                    puts("Distance to target is too far");
-                calculation_failure = true;
-            }
-
-            //if (isnot_real(new_origin.x) || isnot_real(new_origin.y))
-            //    new_origin = prev_origin;//glm::vec2(0.0f);
-
-            nocalc:;
-
-            prev_origin = new_origin;
-            new_origins.push_back(new_origin);
-            remaining_segments.pop_back();
-        }
-
-        if (calculation_failure) {
-            if (debug_pedantic)
-                puts("Failed to calculate");
-            return glfail;
-        } else {
-            if (new_origins.size() < 1) {
-                if (debug_pedantic)
-                    puts("Not enough origins");
-                return glfail;
-            }
-
-            float prevrot = 0.0f;
-            auto prevmag = glm::vec2(0.0f,1.0f);
-            auto prev = glm::vec2(0.0f);
-            new_origins.pop_back();
-            std::reverse(new_origins.begin(), new_origins.end());
-            new_origins.push_back(target_pl2d);
-
-            for (int i = 0; i < new_origins.size(); i++) {
-                auto cur = new_origins[i];
-
-                auto dif = cur - prev;
-                auto mag = glm::normalize(dif);
-
-                auto servo = segments[i + 2];
-                auto calcmag = mag;
-
-                auto rot = atan2(calcmag.x, calcmag.y) - prevrot;
-
-                auto deg = ((glm::degrees(rot)) / 180.0f) * 0.5f + 1.0f;
-                deg *= 360;
-
-                if (isnot_real(deg)) {
-                    deg = rot_out[i + 2];
-                    rot = glm::radians(deg);
-                }
-                
-                if (debug_pedantic)
-                    printf("servo: %i, rot: %.2f, deg: %.2f, prevrot: %.2f, calcmag[0]: %.2f, calcmag[1]: %.2f, cur[0]: %.2f, cur[1]: %.2f, prev[0]: %.2f, prev[1]: %.2f\n", servo->servo_num, rot, deg, prevrot, calcmag.x, calcmag.y, cur.x, cur.y, prev.x, prev.y);
-
-                
-                rot_out[i + 2] = deg;
-
-                prev = cur;
-                prevmag = mag;
-                prevrot = prevrot + rot;
-            }
-        }
-
-        if (debug_pedantic)
-            printf("Initial rot: %.2f,%.2f,%.2f,%.2f,%.2f\n", rot_out[0], rot_out[1], rot_out[2], rot_out[3], rot_out[4]);
-
-        rot_out[1] = serv_6 * 360;
-
-        if (debug_pedantic)
-            printf("End rot: %.2f,%.2f,%.2f,%.2f,%.2f\n", rot_out[0], rot_out[1], rot_out[2], rot_out[3], rot_out[4]);
-        for (int i = 0; i < segments.size(); i++) {
-            auto wrapped = util::wrap(rot_out[i], -180, 180);
-            segments[i]->set_rotation_bound(wrapped);
-        }
-
-        set_sliders_from_segments();
-
-        return glsuccess;
-    }
-};
-
 struct joystick_t {
     struct joystick_device_t {
-        joystick_device_t(int jid):joystick_device_t(get_device(jid).second) {}
-        joystick_device_t() {}
-        
+        static constexpr int axis_total = GLFW_GAMEPAD_AXIS_LAST + 1;
+        static constexpr int button_total = GLFW_GAMEPAD_BUTTON_LAST + 1;
+
+        using buttons_t = std::bitset<button_total>;
+
+        bool connected = false;
         int axis_count, button_count, jid;
         std::string guid, name, gp_name;
-        std::map<int, bool> held_buttons;
-        std::vector<float> deadzones;
+        buttons_t held, previous;
+        float deadzones[axis_total] = {0};
         GLFWgamepadstate state;
 
-        // call keys to update their state and get the updated state, stash output if need be, calling twice will ruin press detection
-        int get_button(int button) {
-            if (state.buttons[button]) {
-                if (held_buttons[button]) {
-                    return GLFW_REPEAT;
-                }
-                held_buttons[button] = 1;
+        // Edge detection is one XOR against the previous update, safe to query any number of times
+        inline buttons_t pressed() const {
+            return (held ^ previous) & held;
+        }
+
+        int get_button(int button) const {
+            if (pressed()[button])
                 return GLFW_PRESS;
-            }
-            held_buttons[button] = 0;
+            if (held[button])
+                return GLFW_REPEAT;
             return 0;
         }
 
         void set_deadzones() {
-            assert(deadzones.size() == axis_count && "Deadzone array length and axis_count\n");
-            memcpy(deadzones.data(), &state.axes, axis_count * sizeof deadzones[0]);
+            memcpy(&deadzones[0], &state.axes, std::min(axis_count, axis_total) * sizeof deadzones[0]);
         }
 
         void update() {
+            previous = held;
+
             if (!glfwGetGamepadState(jid, &state)) {
                 const float *axes = glfwGetJoystickAxes(jid, &axis_count);
                 const unsigned char *buttons = glfwGetJoystickButtons(jid, &button_count);
 
-                if (axis_count < 6 || axis_count > 6) {
-                    // redundant message, axis/button count available in the device object
-                    //std::string msg = std::format("{} axes required (found {})", 6, jd.axis_count);
-                    //jd.gp_name = msg;
-                    if (axis_count < 6)
-                        return;
-                    // copy count based off GLFWgamepadstate
-                    //jd.axis_count = 6;
-                }
+                if (axis_count < 6 || !axes)
+                    return;
 
                 memcpy(&state.axes, axes, sizeof state.axes);
-                memcpy(&state.buttons, buttons, sizeof state.buttons);
+                memset(&state.buttons, 0, sizeof state.buttons);
+                memcpy(&state.buttons, buttons, std::min<int>(button_count, button_total));
 
                 // remap for the controller im using
                 std::swap(state.axes[2], state.axes[4]);
                 std::swap(state.axes[3], state.axes[2]);
             }
-        }
 
-        static std::pair<std::string, joystick_device_t> get_device(int jid) {
-            std::pair<std::string, joystick_device_t> kv;
+            for (int i = 0; i < button_total; i++)
+                held[i] = state.buttons[i] == GLFW_PRESS;
+        }
 
-            auto &jd = kv.second;
-            jd.jid = jid;
+        // Names and GUID are only resolved here, on connect
+        void connect(int jid) {
+            this->jid = jid;
             const char *guid = glfwGetJoystickGUID(jid);
             const char *gp_name = glfwGetGamepadName(jid);
             const char *name = glfwGetJoystickName(jid);
 
-            assert(guid && "GUID null\n");
-
-            if (!guid) 
-                jd.guid = std::to_string((size_t)glfwGetJoystickUserPointer(jid));
-            else
-                jd.guid = guid;
-            if (!gp_name) 
-                jd.gp_name = "Generic";
-            else
-                jd.gp_name = gp_name;
-            if (!name) 
-                jd.name = "Joystick";
-            else
-                jd.name = name;
-
-            kv.first = jd.guid;
-
-            glfwGetJoystickAxes(jid, &jd.axis_count);
-            glfwGetJoystickButtons(jid, &jd.button_count);
-            
-            jd.deadzones.assign(jd.axis_count, 0.0f);
-
-            return kv;
+            this->guid = guid ? guid : std::to_string((size_t)glfwGetJoystickUserPointer(jid));
+            this->gp_name = gp_name ? gp_name : "Generic";
+            this->name = name ? name : "Joystick";
+
+            glfwGetJoystickAxes(jid, &axis_count);
+            glfwGetJoystickButtons(jid, &button_count);
+
+            held.reset();
+            previous.reset();
+            memset(&state, 0, sizeof state);
+            memset(&deadzones[0], 0, sizeof deadzones);
         }
     };
 
-    using map_type = std::map<std::string, joystick_device_t>;
-
-    map_type joysticks;
+    // Slots indexed by GLFW jid
+    joystick_device_t devices[GLFW_JOYSTICK_LAST + 1];
+    int connected_count = 0;
     
     bool pedantic_debug = false;
     bool camera_move = false;
 
-    std::mutex no_reentrancy;
-
-    std::map<int, std::string> button_mapping = {
-        {GLFW_GAMEPAD_BUTTON_GUIDE, "Guide"},
-        {GLFW_GAMEPAD_BUTTON_LEFT_BUMPER, "L1"},
-        {GLFW_GAMEPAD_BUTTON_RIGHT_BUMPER, "R1"},
-        {GLFW_GAMEPAD_BUTTON_B, "B"},
-        {GLFW_GAMEPAD_BUTTON_A, "A"},
-        {GLFW_GAMEPAD_BUTTON_Y, "Y"},
-        {GLFW_GAMEPAD_BUTTON_X, "X"},
-        {GLFW_GAMEPAD_BUTTON_START, "Start"},
-        {GLFW_GAMEPAD_BUTTON_CIRCLE, "Circle"}
+    // Indexed by GLFW button and axis id, unnamed buttons are only shown in pedantic mode
+    static constexpr const char *button_mapping[joystick_device_t::button_total] = {
+        "A", "B", "X", "Y", "L1", "R1", nullptr, "Start", "Guide",
+        nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
     };
 
-    std::map<int, std::string> axis_mapping = {
-        {GLFW_GAMEPAD_AXIS_LEFT_X, "Left X"},
-        {GLFW_GAMEPAD_AXIS_LEFT_Y, "Left Y"},
-        {GLFW_GAMEPAD_AXIS_RIGHT_X, "Right X"},
-        {GLFW_GAMEPAD_AXIS_RIGHT_Y, "Right Y"},
-        {GLFW_GAMEPAD_AXIS_LEFT_TRIGGER, "Left Trig"},
-        {GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER, "Right Trig"}
+    static constexpr const char *axis_mapping[joystick_device_t::axis_total] = {
+        "Left X", "Left Y", "Right X", "Right Y", "Left Trig", "Right Trig"
     };
 
     template<typename T, int c = 3>
@@ -629,9 +307,10 @@ struct joystick_t {
     }
 
     void set_robot(double deltaTime) {
-        for (auto &joy : joysticks) {
-            auto &guid = joy.first;
-            auto &jd = joy.second;
+        for (auto &jd : devices) {
+            if (!jd.connected)
+                continue;
+
             auto &gp = jd.state;
             auto &axes = gp.axes;
             auto &buttons = gp.buttons;
@@ -703,9 +382,12 @@ struct joystick_t {
                 set_v3(ndd, pd, tolerance);
                 ndd = scale_axes(ndd) * deltaTime;
 
-                if (glm::length2(ndd) > 0) {
-                    float s2r = s2->get_rotation(false);
-                    float s1r = s1->get_rotation(false);
+                auto *wrist = robot_chain->find_role("wrist");
+                auto *gripper = robot_chain->find_role("gripper");
+
+                if (glm::length2(ndd) > 0 && wrist && gripper) {
+                    float s2r = wrist->get_rotation(false);
+                    float s1r = gripper->get_rotation(false);
 
                     s2r += ndd.x * deltaTime;
                     s1r -= ndd.y * deltaTime;
@@ -714,8 +396,8 @@ struct joystick_t {
                     s2r = util::clip(s2r, -120, 120); // because we can't check robot_interface unless refactor, works for now
                     s1r = util::clip(s1r, -50, 50);
 
-                    s2->set_rotation(s2r);
-                    s1->set_rotation(s1r);
+                    wrist->set_rotation(s2r);
+                    gripper->set_rotation(s1r);
                 }
             }
         }
@@ -730,10 +412,12 @@ struct joystick_t {
     void connect_robot();
 
     void process_input(double deltaTime) {
-        for (auto &joy : joysticks) {
-            auto &jd = joy.second;
+        for (auto &jd : devices) {
+            if (!jd.connected)
+                continue;
+
             auto &gp = jd.state;
-            auto dz = jd.deadzones.data();
+            auto dz = &jd.deadzones[0];
             int dp[] = {jd.get_button(GLFW_GAMEPAD_BUTTON_DPAD_UP), 
                         jd.get_button(GLFW_GAMEPAD_BUTTON_DPAD_DOWN), 
                         jd.get_button(GLFW_GAMEPAD_BUTTON_DPAD_LEFT), 
@@ -758,7 +442,7 @@ struct joystick_t {
                 rest_robot();
 
             if (!camera_move && (dp[0] || dp[1])) {
-                auto dir = s3->get_segment_vector();
+                auto dir = robot_chain->tip->get_segment_vector();
                 auto sp = vec3_d(dir) * vec3_d(0.01) * deltaTime;
                 if (dp[0])
                     robot_target -= sp;
@@ -776,8 +460,10 @@ struct joystick_t {
             if (camera_move && dp[1] == 1)
                 toggle_fullscreen_state();
 
-            if (camera_move && dp[2] == 1)
+            if (camera_move && dp[2] == 1) {
                 viewport_inversion = glm::scale(viewport_inversion, {-1,-1,1});
+                ui_cache->invalidate();
+            }
 
             if (jd.get_button(GLFW_GAMEPAD_BUTTON_Y) == GLFW_PRESS) {
                 debug_mode = !debug_mode;
@@ -789,58 +475,102 @@ struct joystick_t {
             if (jd.get_button(GLFW_GAMEPAD_BUTTON_X) == GLFW_PRESS)
                 query_robot();
 
-            for (int i = 0; i < jd.axis_count; i++)
+            for (int i = 0; i < std::min(jd.axis_count, jd.axis_total); i++)
                 gp.axes[i] -= dz[i];
         }
     }
 
+    // Connect events arrive through the input queue, never while this runs
+    void poll() {
+        for (auto &jd : devices)
+            if (jd.connected)
+                jd.update();
+    }
+
+    void capture(input_tick_t &tick) {
+        tick.pad_count = 0;
+
+        for (auto &jd : devices) {
+            if (!jd.connected)
+                continue;
+
+            auto &pad = tick.pads[tick.pad_count++];
+            pad.jid = jd.jid;
+            pad.axis_count = jd.axis_count;
+            pad.button_count = jd.button_count;
+            memcpy(&pad.deadzones[0], &jd.deadzones[0], sizeof pad.deadzones);
+            pad.state = jd.state;
+        }
+    }
+
+    // Recorded pads replace the live devices
+    void apply(const input_tick_t &tick) {
+        bool present[GLFW_JOYSTICK_LAST + 1] = {false};
+
+        for (int i = 0; i < tick.pad_count; i++) {
+            auto &pad = tick.pads[i];
+
+            if (pad.jid < GLFW_JOYSTICK_1 || pad.jid > GLFW_JOYSTICK_LAST)
+                continue;
+
+            auto &jd = devices[pad.jid];
+
+            if (!jd.connected) {
+                jd.jid = pad.jid;
+                jd.guid = "playback";
+                jd.name = jd.gp_name = "Playback";
+                jd.held.reset();
+                jd.connected = true;
+            }
+
+            jd.axis_count = pad.axis_count;
+            jd.button_count = pad.button_count;
+            memcpy(&jd.deadzones[0], &pad.deadzones[0], sizeof jd.deadzones);
+            jd.state = pad.state;
+            jd.previous = jd.held;
+
+            for (int b = 0; b < jd.button_total; b++)
+                jd.held[b] = jd.state.buttons[b] == GLFW_PRESS;
+
+            present[pad.jid] = true;
+        }
+
+        connected_count = 0;
+
+        for (int jid = GLFW_JOYSTICK_1; jid <= GLFW_JOYSTICK_LAST; jid++) {
+            devices[jid].connected = present[jid];
+            connected_count += present[jid];
+        }
+    }
+
     void update(double deltaTime) {
-        GLFWgamepadstate p;
-        glfwGetGamepadState(0, &p);
+        PROFILE_SCOPE("joystick_t::update");
 
-        if (!no_reentrancy.try_lock())
+        if (connected_count < 1)
             return;
 
-        for (auto &joy : joysticks)
-            joy.second.update();
-
         process_input(deltaTime);
         set_robot(deltaTime);
-
-        no_reentrancy.unlock();
     }
 
-    std::string debug_info() {
-        std::string info;
-        for (auto &joy : joysticks) {
-            auto &jid = joy.first;
-            auto &jd = joy.second;
-            info += std::format("Joystick: {}\n  Axes: {}\n  Buttons: {}\n  Jid: {}\n", jd.gp_name, jd.axis_count, jd.button_count, jd.jid);
+    void debug_info(char *buffer, const size_t &size, size_t &offset) {
+        for (auto &jd : devices) {
+            if (!jd.connected)
+                continue;
+
+            util::format_to(buffer, size, offset, "Joystick: {}\n  Axes: {}\n  Buttons: {}\n  Jid: {}\n", jd.gp_name, jd.axis_count, jd.button_count, jd.jid);
             auto &gp = jd.state;
-            for (int i = 0; i < sizeof gp.axes / sizeof gp.axes[0]; i++) {
-                info += std::format("  {}: {}\n", axis_mapping[i], gp.axes[i]);
+            for (int i = 0; i < jd.axis_total; i++) {
+                util::format_to(buffer, size, offset, "  {}: {}\n", axis_mapping[i], gp.axes[i]);
             }
-            auto &jh = jd.held_buttons;
-            for (int i = 0; i < sizeof gp.buttons / sizeof gp.buttons[0]; i++) {
-                if (button_mapping.contains(i))
-                    info += std::format("  {}: {} {}\n", button_mapping[i], gp.buttons[i], jh[i]);
+            for (int i = 0; i < jd.button_total; i++) {
+                if (button_mapping[i])
+                    util::format_to(buffer, size, offset, "  {}: {} {}\n", button_mapping[i], gp.buttons[i], (int)jd.held[i]);
                 else
                 if (pedantic_debug)
-                    info += std::format("  {}: {} {}\n", i, gp.buttons[i], jh[i]);
+                    util::format_to(buffer, size, offset, "  {}: {} {}\n", i, gp.buttons[i], (int)jd.held[i]);
             }
-            /*
-            const auto *buttons = glfwGetJoystickButtons(jd.jid, &jd.button_count);
-            for (int i = 0; i < jd.button_count; i++)
-                info += std::format("+{}: {}{}", i, buttons[i], (i+1) % 4 == 0 ? '\n' : ' ');
-            info += "\n";
-            */
         }   
-        return info;
-    }
-
-    void remove(const std::string &guid) {
-        fprintf(stderr, "Remove joystick %s\n", guid.c_str());
-        joysticks.erase(guid);
     }
 
     void reset() {
@@ -848,28 +578,31 @@ struct joystick_t {
     }
 
     void query_joysticks() {
-        map_type joys = map_type();
         static bool first_run = true;
 
-        for (int jid = GLFW_JOYSTICK_1; jid < GLFW_JOYSTICK_LAST; jid++) {
-            if (!glfwJoystickPresent(jid))
-                continue;
+        connected_count = 0;
 
-            // Note, GUID can match two discrete joysticks from a single device
+        for (int jid = GLFW_JOYSTICK_1; jid <= GLFW_JOYSTICK_LAST; jid++) {
+            auto &jd = devices[jid];
+            bool present = glfwJoystickPresent(jid);
 
-            auto kv = joystick_device_t::get_device(jid);
-            auto &jd = kv.second;
+            if (!present && jd.connected) {
+                fprintf(stderr, "Remove joystick %i \"%s\" \"%s\" \"%s\"\n", jid, jd.gp_name.c_str(), jd.name.c_str(), jd.guid.c_str());
+                jd.connected = false;
+            }
+
+            if (!present)
+                continue;
 
-            if (joysticks.contains(kv.first)) {
-                //joys.insert({kv.first, joysticks[kv.first]});
-                using it = map_type::iterator;
-                using mv = std::move_iterator<it>;
-                it p = joysticks.find(kv.first);
-                joys.insert(mv(p),mv(p));
+            if (jd.connected) {
+                connected_count++;
                 continue;
             }
 
-            if (kv.second.axis_count != 6) {
+            // Note, GUID can match two discrete joysticks from a single device
+            jd.connect(jid);
+
+            if (jd.axis_count != 6) {
                 if (first_run && debug_mode)
                     fprintf(stderr, "6 axes joystick device required, device %i \"%s\" \"%s\" \"%s\"\n", jid, jd.gp_name.c_str(), jd.name.c_str(), jd.guid.c_str());
                 continue;
@@ -878,301 +611,131 @@ struct joystick_t {
             fprintf(stderr, "Add joystick %i \"%s\" \"%s\" \"%s\"\n", jid, jd.gp_name.c_str(), jd.name.c_str(), jd.guid.c_str());
             jd.update();
             jd.set_deadzones();
-            joys.insert(kv);
+            jd.connected = true;
+            connected_count++;
         }
 
-        for (auto &jd : joysticks) 
-            if (!joys.contains(jd.first))
-                fprintf(stderr, "Remove joystick %i \"%s\" \"%s\" \"%s\"\n", jd.second.jid, jd.second.gp_name.c_str(), jd.second.name.c_str(), jd.second.guid.c_str());
-
         first_run = false;
-        joysticks = std::move(joys);
+        poll();
         update(0.1);
     }
 };
 
-struct robot_interface_t {
-    hid_device *handle;
-    std::string serial_number;
-    bool servo_sleep_on_destroy = true;
-    bool virtual_output = false;
-
-    using clk = std::chrono::high_resolution_clock;
-    using tp = std::chrono::time_point<clk>;
-    using dur = std::chrono::duration<long, std::milli>;
-
-    template<typename RB, 
-             typename PERIOD_T = int,
-             typename SERVO_T = RB::servo_type,
-             typename VT_T = RB::value_type,
-             typename RB_TP = RB::tp,
-             typename PAIR_T = std::pair<SERVO_T,SERVO_T>>
-        requires std::is_base_of_v<robot_servo_T<SERVO_T, VT_T>, RB>
-    bool get_servo_command(RB *servo, PERIOD_T &r_period, RB_TP &batch_time, PAIR_T &cmd) {
-        auto targetf = servo->get_clamped_rotation();
-        auto targeti = servo->get_servo(targetf);//servo->to_servo(targetf);
-        auto servo_min = servo->servo_min;
-        auto servo_max = servo->servo_max;
-        auto initialp = servo->get_servo_start();
-        auto initialpf = servo->get_servo_degrees(initialp);
-        auto intrp = servo->get_servo_interpolated();
-
-        if (targeti < servo_min || targeti > servo_max)
-            targeti = util::clip(targeti, servo_min, servo_max);
-
-        auto dist = targeti - intrp;
-
-        servo->last_command = batch_time;
-
-        if (abs(dist) < servo->min_command_threshold && abs(dist) < 1) {
-            servo->servo_end_position = targeti;
-            servo->servo_cur_position = targeti;
-            return false;
-        }
-
-        auto mv = (r_period/1000.0) * servo->degrees_per_second;
-        auto mvdist = servo->servo_cur_position - intrp;
-        auto accel = mvdist / mv;
-        auto jerk = (mvdist * mv) / mv;
-        auto rintrp = intrp;
-
-        if (abs(jerk) > mv / 2 && abs(mvdist) > 0) {
-            intrp += (mvdist * .5);
-        } else
-        if (abs(dist) < mv / 2 && abs(jerk) < mv / 4) {
-            intrp = targeti;
-            if (debug_pedantic)
-                fprintf(stderr, "Force set targeti\n");
-        }
-
-        servo->servo_end_position = targeti;
-        servo->servo_cur_position = intrp;
-
-        if (debug_pedantic)
-            fprintf(stderr, "Send constant time s%i (%i/initialp -> %i/rintrp (jerk comp %i/intrp)) (%i/mvdist) (%i/targeti %.2f/targetf : %.2f/initialpf) = %i/dist (%i r_period/ms %.2lf mv/intpersec) accel %.2f jerk %.2f\n", servo->servo_num, initialp, rintrp, intrp, mvdist, targeti, targetf, initialpf, dist, r_period, mv, accel, jerk);
-
-        cmd = { servo->servo_num, intrp };
-
-        return true;
-    }
-
-    void update() {
-        if (!handle && !virtual_output)
-            return;
-
-        using sv_t = segment_t::servo_type;
-        using tp_t = segment_t::tp;
-        using clk_t = segment_t::clk;
-        using pair_t = std::pair<sv_t, sv_t>;
-
-        static tp_t last_batch = clk_t::now();
-        tp now_batch = clk_t::now();
-
-        static bool constant_speed = false;
-        static int u_period = 10;
-        static int m_period = 200;
-        static int t_overlap = 0;
-        int r_period = int(std::chrono::duration_cast<dur>(now_batch - last_batch).count()) + t_overlap;
-
-        if (!constant_speed && r_period < u_period)
-            return;
-
-        if (!constant_speed && r_period > m_period)
-            r_period = m_period;
-
-        std::vector<pair_t> cmds;
-
-        for (auto *sv : servo_segments) {
-            pair_t p;
-            if (get_servo_command(sv, r_period, now_batch, p))
-                cmds.push_back(p);
-        }
-
-        if (cmds.size() > 0) {
-            set_servos(cmds, r_period);
-            last_batch = now_batch;
-        }
-    }
-
-    robot_interface_t(bool permit_virtual = false):virtual_output(permit_virtual) {
-        init();
-    }
-
-    ~robot_interface_t() {
-        destroy();
-    }
-
-    void destroy() {
-        if (handle) {
-            if (servo_sleep_on_destroy)                
-                servos_off();
-            fprintf(stderr, "Close robot connection\n");
-            close();
-        }
-        hid_exit();
-    }
-
-    std::string get_hid_error() {
-        std::wstring err = hid_error(0);
-        return std::string(err.begin(), err.end());
+void print_servo_positions(robot_chain_t *chain) {
+    for (auto *seg : chain->servos) {
+        fprintf(stderr, "%i: %i (%.2f deg), ", seg->servo_num, seg->servo_cur_position, seg->to_degrees(seg->servo_cur_position));
     }
+    fputs("\n", stderr);
+}
 
-    void read_all(bool set_pos = false) {
-        if (!handle)
-            return;
-
-        const unsigned char cmd[11] = {
-            0x55, 0x55, 9, 21, 6, 1, 2, 3, 4, 5, 6
+/*
+One arm with its own chain, IK, target and HID connection.
+Input and the sliders drive the selected robot through the robot_chain,
+robot_interface, kinematics and robot_target globals, select_robot
+repoints them. Arms share meshes and only differ by their placement.
+*/
+struct robot_instance_t {
+    robot_chain_t chain;
+    kinematics_t kinematics;
+    robot_interface_t interface;
+    vec3_d target;
+    std::wstring serial;
+    // Print the positions when the requested read lands
+    bool report_positions = false;
+
+    robot_instance_t(const std::wstring &serial):
+    kinematics(&chain),
+    interface(&chain, true),
+    target(0.0),
+    serial(serial) {
+        kinematics.benchmark = interface.benchmark = benchmark;
+        kinematics.collision_checking = collision_checking;
+
+        // Sliders follow the selected robot only
+        kinematics.solved_callback = [](kinematics_t *solved) {
+            if (solved->chain == robot_chain)
+                set_sliders_from_segments();
         };
-        hid_write(handle, &cmd[0], 11);
 
-        unsigned char ret[100];
-        int count = hid_read_timeout(handle, &ret[0], 100, 2000);
-        if (count < 6) {
-            if (debug_mode)
-                fprintf(stderr, "Failed to read any bytes\n%s\n", get_hid_error().c_str());
-            return;
-        }
-
-        count = ret[4];
+        interface.telemetry_callback = [this](robot_interface_t*) {
+            if (report_positions) {
+                report_positions = false;
+                print_servo_positions(&chain);
+            }
 
-        auto now_time = segment_t::clk::now();
-        for (int i = 0; i < count; i++) {
-            auto *seg = servo_segments[i];
-            int index = 5 + 3 * i;
-            int id = ret[index];
-            int pos = (ret[index + 2] << 8) | ret[index + 1];
-            unsigned short upos = (unsigned short)pos;
-            seg->servo_cur_position = upos;
-            if (set_pos)
-                seg->servo_end_position = upos;
-            seg->last_command = now_time;
-            if (debug_pedantic)
-                fprintf(stderr, "s%i r%i p%i\n", id, seg->servo_cur_position, seg->servo_end_position);
-        }
+            request_redraw();
+        };
     }
 
-    //set no check
-    void set_servo(int id, int position, int millis = 1000) {
-        if (!handle)
-            return;
-            
-        set_servos({{id,position}}, millis);
+    bool connect(const robot_description_t &description) {
+        bool failed = interface.open(description.vendor_id, description.product_id, serial.empty() ? nullptr : serial.data());
+        target = chain.get_tip(false);
+        return failed;
     }
+};
 
-    //set no check
-    void set_servos(const std::vector<std::pair<int,int>> &poses, const int time = 1000) {
-        if (!handle)
-            return;
+void select_robot(int index) {
+    if (robot_chain)
+        robots[active_robot]->target = robot_target;
 
-        const int count = poses.size() * 3 + 7;
-        assert(poses.size() > 0 && "No poses");
-        assert(poses.size() < 255 && count < 255 && "Should not be that big\n");
-        unsigned char cmd[count];
-        unsigned char header[7] = {0x55, 0x55, (unsigned char)(count - 2), 0x03, (unsigned char)(poses.size()),
-            (unsigned char)(time & 0xFF), (unsigned char)(time >> 8)
-        };
-        memcpy(&cmd[0], &header[0], 7);
-
-        int i = 0;
-        for (auto &sv : poses) {
-            int offset = i++ * 3 + 7;
-            cmd[offset] = sv.first;
-            cmd[offset+1] = sv.second & 0xFF;
-            cmd[offset+2] = sv.second >> 8;
-        }
+    active_robot = index % robots.size();
 
-        hid_write(handle, &cmd[0], count);
-    }
+    auto *robot = robots[active_robot];
+    robot_chain = &robot->chain;
+    robot_interface = &robot->interface;
+    kinematics = &robot->kinematics;
+    robot_target = robot->target;
 
-    //set no check
-    void servos_off() {
-        if (!handle)
-            return;
+    set_sliders_from_segments();
+    request_redraw();
+}
 
-        unsigned char cmd[11] = { 0x55, 0x55, 9, 20, 6, 1, 2, 3, 4, 5, 6 };
-        hid_write(handle, &cmd[0], 11);
-        usleep(100000); //why doesn't the command work every time, im trying to fix it
-    }
+// One robot per serial, found on the bus unless given with --serial, or one virtual robot
+bool create_robots() {
+    hid_init();
 
-    void init() {
-        hid_init();
-        handle = nullptr;
-    }
+    auto serials = robot_serials;
 
-    void set_robot_defaults() {
-        if (!handle && virtual_output)
-            serial_number = "Virtual Robot";
-    }
+    if (serials.empty())
+        serials = robot_interface_t::enumerate(robot_description->vendor_id, robot_description->product_id);
 
-    int open(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number_w = nullptr) {
-        if (handle)
-            close();
-        handle = hid_open(vendor_id, product_id, serial_number_w);
+    if (serials.empty())
+        serials.push_back(std::wstring());
 
-        if (!handle) {
-            if (virtual_output) {
-                fprintf(stderr, "No handle, create virtual output\n");
-                set_robot_defaults();
-                return glsuccess;
-            }
-            std::wstring err = hid_error(0);
-            std::string rr(err.begin(), err.end());
-            fprintf(stderr, "Not connected to robot, (nonfatal) reason: %s\n", rr.c_str());
-            serial_number = "No USB";
-            return glfail;
-        }
+    for (int i = 0; i < serials.size(); i++) {
+        auto *robot = new robot_instance_t(serials[i]);
+        auto *shared = i > 0 ? &robots[0]->chain : nullptr;
 
-        std::wstring wstr;
-        if (!serial_number_w) {
-            wchar_t wbuf[100];
-            if (!hid_get_serial_number_string(handle, &wbuf[0], 100))
-                wstr = std::wstring(&wbuf[0]);
-            else 
-                wstr = L"No serial";
-        } else {
-            wstr = std::wstring(serial_number_w);
-        }
-        serial_number = std::string(wstr.begin(), wstr.end());
+        if (robot->chain.compile(*robot_description, shared))
+            return glfail;
 
-        hid_set_nonblocking(handle, 0);
-        fprintf(stderr, "Open robot connection\n");
+        // Side by side around where the description places the arm
+        robot->chain.segments.front().offset += glm::vec3(0.0f, 0.0f, robot_spacing * (i - (serials.size() - 1) / 2.0f));
+        robot->target = robot->chain.get_tip(false);
 
-        set_robot_defaults();
-        read_all(true);
-        set_segments_from_robot();
+        for (auto *seg : robot->chain.visible)
+            visible_segments.push_back(seg);
 
-        return glsuccess;
+        robots.push_back(robot);
     }
 
-    void close() {
-        if (!handle)
-            return;
-        hid_close(handle);
-        handle = nullptr;
-    }
+    if (robots.size() > 1)
+        fprintf(stderr, "Driving %i robots, tab selects\n", (int)robots.size());
 
-    // Try to close and open connection, do not destroy
-    void reset(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number_w = nullptr) {
-        open(vendor_id, product_id, serial_number_w);
-    }
+    select_robot(0);
 
-    std::string debug_info() {
-        std::string ret;
-        ret += std::format("USB: {}\n", serial_number);
-        for (auto *seg : servo_segments) {
-            ret += std::format("  {}: {}\n", seg->servo_num, seg->servo_cur_position);
-        }
-        return ret;
-    }
-};
+    return glsuccess;
+}
 
+// Reads complete on a later update once the control thread runs, the telemetry callback prints them
 void joystick_t::query_robot() {
-    robot_interface->read_all();
-    for (auto *seg : servo_segments) {
-        fprintf(stderr, "%i: %i (%.2f deg), ", seg->servo_num, seg->servo_cur_position, seg->to_degrees(seg->servo_cur_position));
+    if (!robot_interface->handle) {
+        print_servo_positions(robot_chain);
+        return;
     }
-    fputs("\n", stderr);
+
+    robots[active_robot]->report_positions = true;
+    robot_interface->read_all();
 }
 
 void joystick_t::rest_robot() {
@@ -1198,15 +761,15 @@ void joystick_t::rest_position_robot() {
 }
 
 void joystick_t::connect_robot() {
-    robot_interface->open(1155, 22352);
+    robots[active_robot]->connect(*robot_description);
     set_segments_from_robot();
 }
 
 void set_segments_from_sliders() {
-    for (int i = 0; i < servo_sliders.size() && i < servo_segments.size(); i++)
-        servo_segments[i]->set_rotation_bound(servo_sliders[i]->value);
+    for (int i = 0; i < servo_sliders.size() && i < robot_chain->servos.size(); i++)
+        robot_chain->servos[i]->set_rotation_bound(servo_sliders[i]->value);
 
-    robot_target = s3->get_origin(false) + s3->get_segment_vector(false);
+    robot_target = robot_chain->get_tip(false);
 }
 
 void servo_slider_update(ui_slider_t* ui, ui_slider_t::ui_slider_v value) {
@@ -1245,13 +808,13 @@ void update_whatever(ui_slider_t* ui, ui_slider_t::ui_slider_v value) {
 }
 
 void set_sliders_from_segments() {
-    for (int i = 0; i < servo_sliders.size() && i < servo_segments.size(); i++)
-        servo_sliders[i]->set_value(servo_segments[i]->get_clamped_rotation(), false);
+    for (int i = 0; i < servo_sliders.size() && i < robot_chain->servos.size(); i++)
+        servo_sliders[i]->set_value(robot_chain->servos[i]->get_clamped_rotation(), false);
 }
 
 void set_segments_from_robot() {
-    for (int i = 0; i < servo_sliders.size() && i < servo_segments.size(); i++) {
-        auto *sg = servo_segments[i];
+    for (int i = 0; i < servo_sliders.size() && i < robot_chain->servos.size(); i++) {
+        auto *sg = robot_chain->servos[i];
         auto *ui = servo_sliders[i];
         sg->set_rotation(sg->get_servo_interpolated_degrees());
         ui->set_value(sg->get_clamped_rotation(), false);
@@ -1259,50 +822,54 @@ void set_segments_from_robot() {
             fprintf(stderr, "%i -> %s (%f -> %f)\n", sg->servo_num, ui->title_cached.c_str(), sg->get_rotation(false), sg->get_clamped_rotation());
     }
 
-    robot_target = s3->get_origin(false) + s3->get_segment_vector(false);
+    robot_target = robot_chain->get_tip(false);
 }
 
 void set_robot_from_segments() {
     for (int i = 0; i < servo_sliders.size(); i++) {
-        auto *sg = servo_segments[i];
+        auto *sg = robot_chain->servos[i];
         sg->set_servo(sg->get_servo_interpolated());
     }
 }
 
-std::string segment_debug_info() {
-    std::string ret = "";
-    ret += std::format("{:>7} {: >12s} {: >13s}\n", "Servos:", "Interpolated", "Immediate");
+void segment_debug_info(char *buffer, const size_t &size, size_t &offset) {
+    util::format_to(buffer, size, offset, "{:>7} {: >12s} {: >13s}\n", "Servos:", "Interpolated", "Immediate");
 
-    auto get_segment = [&](segment_t *seg) {
-        return std::format("{:>3}: {:>9.2f} {:>5} {:>7.2f} {:>5}\n", seg->servo_num, seg->get_servo_interpolated_degrees(), seg->get_servo_interpolated(), seg->get_servo_degrees(), seg->get_servo());
-    };
-
-    for (auto *seg : servo_segments)
-        ret += get_segment(seg);
-
-    return ret;
+    for (auto *seg : robot_chain->servos)
+        util::format_to(buffer, size, offset, "{:>3}: {:>9.2f} {:>5} {:>7.2f} {:>5}\n", seg->servo_num, seg->get_servo_interpolated_degrees(), seg->get_servo_interpolated(), seg->get_servo_degrees(), seg->get_servo());
 }
 
 void update_debug_info() {
     {
-        const int bufsize = 1000;
-        char char_buf[bufsize];
+        // Rebuilt every frame, kept off the heap
+        static char char_buf[8192];
+        const size_t bufsize = sizeof char_buf;
 
-        glm::vec3 s3_t = s3->get_segment_vector() + s3->get_origin();
+        glm::vec3 s3_t = robot_chain->get_tip();
         
-        debug_objects->add_sphere(robot_target, s3->model_scale);
+        debug_objects->add_sphere(robot_target, robot_chain->tip->model_scale);
 
-        snprintf(char_buf, bufsize, 
-        "%.0lf FPS %.2lf ms\nCamera %.2f %.2f %.2f\nFacing %.2f %.2f\nTarget %lf %lf %lf\ns3 %.2f %.2f %.2f\n%s%s%s",
-        frametime.get_fps(), frametime.get_ms(), 
+        int len = snprintf(char_buf, bufsize, 
+        "%.0lf FPS %.2lf ms %.0lf Hz sim %i ticks\nCamera %.2f %.2f %.2f\nFacing %.2f %.2f\nTarget %lf %lf %lf\nTip %.2f %.2f %.2f\n",
+        frametime.get_fps(), frametime.get_ms(), sim_clock_t::tick_rate, sim_clock_t::frame_ticks,
         camera->position.x, camera->position.y, camera->position.z,
         camera->yaw,camera->pitch,
         robot_target.x, robot_target.y, robot_target.z,
-        s3_t.x,s3_t.y,s3_t.z,
-        joysticks->debug_info().c_str(),
-        segment_debug_info().c_str(),
-        robot_interface->debug_info().c_str()
+        s3_t.x,s3_t.y,s3_t.z
         );
+
+        size_t offset = std::min<size_t>(std::max(len, 0), bufsize - 1);
+
+        joysticks->debug_info(char_buf, bufsize, offset);
+        segment_debug_info(char_buf, bufsize, offset);
+        if (robots.size() > 1)
+            util::format_to(char_buf, bufsize, offset, "Robot {}/{}\n", active_robot + 1, robots.size());
+        robot_interface->debug_info(char_buf, bufsize, offset);
+        gpu_timer->debug_info(char_buf, bufsize, offset);
+
+        if (gui::profiler_t::enabled)
+            gui::profiler_t::timeline(char_buf, bufsize, offset);
+
         debugInfo->set_string(&char_buf[0]);
     }
 }
@@ -1318,27 +885,99 @@ void outputTest() {
     glEnd();
 }
 
-int init_context() {
-    if (!glfwInit())
-        handle_error("Failed to initialize GLFW");
+bool reload_shader(shader_t *shader) {
+    if (shader->load(shader->path))
+        return glfail;
 
-    initial_window = {0,0,1600,900};
+    bool ret = glsuccess;
+    shader_program_t *programs[] = { mainProgram, textProgram, debugProgram };
 
-    window = glfwCreateWindow(initial_window[2], initial_window[3], "xArm", nullptr, nullptr);
+    for (auto *program : programs)
+        if (program->has_shader(shader))
+            ret |= program->load();
 
-    if (!window)
-        handle_error("Failed to create GLFW window");
+    ui_cache->invalidate();
 
-    glfwMakeContextCurrent(window);
+    return ret;
+}
 
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, cursor_position_callback);
-    glfwSetMouseButtonCallback(window, mouse_button_callback);
-    glfwSetJoystickCallback(joystick_callback);
-    glfwSwapInterval(1);
+void watch_resources() {
+    shader_t *shaders[] = { mainVertexShader, mainFragmentShader, textVertexShader, textFragmentShader, debugVertexShader, debugFragmentShader };
 
-    glfwGetWindowPos(window, &initial_window.x, &initial_window.y);
-    glfwGetWindowSize(window, &initial_window[2], &initial_window[3]);
+    for (auto *shader : shaders)
+        file_watcher->watch(shader->path, [shader](const std::string &path) {
+            return reload_shader(shader);
+        });
+
+    // Meshes are shared, the first robot holds them
+    auto &chain = robots[0]->chain;
+
+    for (int i = 0; i < chain.meshes.size(); i++) {
+        std::string obj = chain.mesh_paths[i];
+        std::string mtl = obj.substr(0, obj.find_last_of('.')) + ".mtl";
+        auto reload_mesh = [&chain, i, obj](const std::string &path) {
+            if (chain.meshes[i]->reloadObj(obj.c_str()))
+                return glfail;
+
+            chain.build_bvh(i);
+            return glsuccess;
+        };
+
+        file_watcher->watch(obj, reload_mesh);
+        file_watcher->watch(mtl, reload_mesh);
+    }
+
+    file_watcher->watch("assets/text.png", [](const std::string &path) {
+        ui_cache->invalidate();
+        return textTexture->load(path);
+    });
+}
+
+int init_headless_context() {
+    initial_window = {0,0,1600,900};
+    current_window = initial_window;
+
+    headless_context = new headless_context_t();
+
+    if (frame_dump_prefix)
+        headless_context->dump_prefix = frame_dump_prefix;
+
+    if (headless_context->init(initial_window[2], initial_window[3]))
+        handle_error("Failed to create headless context");
+
+    signal(SIGTERM, handle_signal);
+    signal(SIGINT, handle_signal);
+
+    return glsuccess;
+}
+
+int init_context() {
+    input = new gui::events::InputDispatcher();
+
+    if (headless)
+        return init_headless_context();
+
+    if (!glfwInit())
+        handle_error("Failed to initialize GLFW");
+
+    initial_window = {0,0,1600,900};
+
+    window = glfwCreateWindow(initial_window[2], initial_window[3], "xArm", nullptr, nullptr);
+
+    if (!window)
+        handle_error("Failed to create GLFW window");
+
+    glfwMakeContextCurrent(window);
+
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, cursor_position_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetJoystickCallback(joystick_callback);
+    glfwSwapInterval(benchmark ? 0 : 1);
+
+    glfwGetWindowPos(window, &initial_window.x, &initial_window.y);
+    glfwGetWindowSize(window, &initial_window[2], &initial_window[3]);
 
     current_window = initial_window;
 
@@ -1357,9 +996,12 @@ int init() {
     mainFragmentShader = new shader_t(GL_FRAGMENT_SHADER);
     textVertexShader = new shader_t(GL_VERTEX_SHADER);
     textFragmentShader = new shader_t(GL_FRAGMENT_SHADER);
+    debugVertexShader = new shader_t(GL_VERTEX_SHADER);
+    debugFragmentShader = new shader_t(GL_FRAGMENT_SHADER);
 
     mainProgram = new shader_materials_t(shader_program_t(mainVertexShader, mainFragmentShader));
     textProgram = new shader_text_t(shader_program_t(textVertexShader, textFragmentShader));
+    debugProgram = new shader_program_t(debugVertexShader, debugFragmentShader);
 
     mainTexture = new texture_t();
     textTexture = new texture_t();
@@ -1367,22 +1009,29 @@ int init() {
     robotMaterial = new material_t(mainTexture,mainTexture,1.0f);
 
     uiHandler = new ui_element_t(window, {-1.0f,-1.0f,2.0f,2.0f});
+    ui_batcher = new ui_batch_t();
+    ui_cache = new ui_cache_t(textProgram);
+    gpu_timer = new gpu_timer_t();
+    gpu_timer->init();
     //uiHandler->add_child(new ui_text_t(window, {0.0,0.0,.1,.1}, "Hello World!"));
     debugInfo = uiHandler->add_child(new ui_text_t(window, textProgram, textTexture, {-1.0f,-1.0f,2.0f,2.0f}, "", update_debug_info));
-    debug_objects = new debug_object_t();
+    debug_objects = new debug_draw_t(debugProgram);
     ui_servo_sliders = uiHandler->add_child(new ui_element_t(window, uiHandler->XYWH));
 
     glm::vec4 sliderPos = {0.45, -0.95,0.5,0.1};
     glm::vec4 sliderAdd = {0.0,0.2,0,0};
     glm::vec2 sMM = {-180, 180.};
     
+    robot_description = new robot_description_t();
+
+    if (robot_description->load(robot_path) || create_robots())
+        return glfail;
+
     int sl = 0;
-    slider6 = ui_servo_sliders->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos, sMM.x, sMM.y, sl++, "Servo 6", true, servo_slider_update));
-    slider5 = ui_servo_sliders->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos + (sliderAdd * glm::vec4(sl++)), sMM.x, sMM.y, 0., "Servo 5", true, servo_slider_update));
-    slider4 = ui_servo_sliders->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos + (sliderAdd * glm::vec4(sl++)), sMM.x, sMM.y, 0., "Servo 4", true, servo_slider_update));
-    slider3 = ui_servo_sliders->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos + (sliderAdd * glm::vec4(sl++)), sMM.x, sMM.y, 0., "Servo 3", true, servo_slider_update));
-    slider2 = ui_servo_sliders->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos + (sliderAdd * glm::vec4(sl++)), sMM.x, sMM.y, 0., "Servo 2", true, servo_slider_update));
-    slider1 = ui_servo_sliders->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos + (sliderAdd * glm::vec4(sl++)), sMM.x, sMM.y, 0., "Servo 1", true, servo_slider_update));
+    for (auto *seg : robot_chain->servos) {
+        std::string title = "Servo " + std::to_string(seg->servo_num);
+        servo_sliders.push_back(ui_servo_sliders->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos + (sliderAdd * glm::vec4(sl++)), sMM.x, sMM.y, 0., title, true, servo_slider_update)));
+    }
     //debugInfo = new ui_text_t(window, {0.0,0.0,1.,1.}, "Hello world 2!");
     
     slider_ambient = debugInfo->add_child(new ui_slider_t(window, textProgram, textTexture, sliderPos + (sliderAdd * glm::vec4(sl++)), -2., 2., -0.3, "Ambient Light", false));
@@ -1431,7 +1080,8 @@ int init() {
     }));
     resetConnectionToggle = debugInfo->add_child(new ui_toggle_t(window, textProgram, textTexture, toggle_pos += toggle_add, "Conn", false, [](ui_toggle_t *ui, bool state) {
         if (state) {
-            robot_interface->reset(1155, 22352);
+            robots[active_robot]->connect(*robot_description);
+            set_segments_from_robot();
             resetConnectionToggle->set_state(false);
         }
     }));
@@ -1439,21 +1089,10 @@ int init() {
         debug_pedantic = state;
     }));
 
-    for (int i = 0; i < 5; i++)
-        meshes.push_back(new mesh_t);
-
-    segment_t **s_pos[] = { &sBase, &s6, &s5, &s4, &s3, &s2, &s1 };
-
-    for (int i = 0; i < 7; i++)
-        segments.push_back(*s_pos[i] = new segment_t);
-
-    visible_segments = std::vector<segment_t*>({sBase, s6, s5, s4, s3});
-    servo_segments = std::vector<segment_t*>({s6, s5, s4, s3, s2, s1});
-    servo_sliders = std::vector({slider6, slider5, slider4, slider3, slider2, slider1});
-    kinematics = new kinematics_t();
-
     joysticks = new joystick_t;
-    robot_interface = new robot_interface_t(true);
+    file_watcher = new file_watch_t();
+
+    register_input();
 
     return glsuccess;
 }
@@ -1464,11 +1103,11 @@ void reset() {
     camera->yaw = 0.001;
     camera->pitch = 0.001;
     camera->fov = 90;
-    for (auto &seg : servo_segments)
+    for (auto &seg : robot_chain->servos)
         seg->set_rotation(0);
     set_sliders_from_segments();
     set_robot_from_segments();
-    robot_target = s3->get_segment_vector(false) + s3->get_origin(false);
+    robot_target = robot_chain->get_tip(false);
 }
 
 int load() {
@@ -1479,69 +1118,31 @@ int load() {
     if (mainVertexShader->load("shaders/vertex.glsl") ||
 mainFragmentShader->load("shaders/fragment.glsl") ||
 textVertexShader->load("shaders/text_vertex_shader.glsl") ||
-textFragmentShader->load("shaders/text_fragment_shader.glsl"))
+textFragmentShader->load("shaders/text_fragment_shader.glsl") ||
+debugVertexShader->load("shaders/debug_vertex.glsl") ||
+debugFragmentShader->load("shaders/debug_fragment.glsl"))
         handle_error("Failed to load shaders");
 
     if ((mainProgram->load() ||
-        textProgram->load()))
+        textProgram->load() ||
+        debugProgram->load()))
         handle_error("Failed to compile shaders");
 
-    /*
-        Forward: -Y
-        Up: Z
-        UV, Triangulate, Normals, Modifiers
-        Selection only
-
-        Shade auto smooth 30*
-        Merge by distance 0.00001
-        Origin on pivot point
-    */
-    const char *mesh_locs[5] = {
-        "assets/xarm-sbase.obj",
-        "assets/xarm-s6.obj",
-        "assets/xarm-s5.obj",
-        "assets/xarm-s4.obj",
-        "assets/xarm-s3.obj"
-    };
-
-    int dhome = 500;
-    int dpos = 500;
-    int drp = 500;
-    float dconv = 240.0f / 1000.0f;
-
-    segment_t::robot_servo_type servo_vals[7] = {
-        {},
-        { 6, 0, 1146, 482, dpos, drp, 700.0f, dconv },  // base
-        { 5, 148, 882, 505, dpos, drp, 700.0f, dconv }, // 5
-        { 4, 0, 1042, 502, dpos, drp, 700.0f, -dconv }, // 4 (inverted)
-        { 3, 38, 1000, dhome, dpos, drp, 700.0f, dconv }, // 3
-        { 2, 0, 925, dhome, dpos, drp, 700.0f, dconv }, // wrist
-        { 1, 200, 850, dhome, dpos, drp, 641.0f, dconv } // gripper
-    };
-
-    segment_t segment_vals[7] = {
-        {nullptr, meshes[0], servo_vals[0], z_axis, 46.19},
-        {sBase, meshes[1], servo_vals[1], z_axis, 35.98},
-        {s6, meshes[2], servo_vals[2], y_axis, 100.0},
-        {s5, meshes[3], servo_vals[3], y_axis, 96.0},
-        {s4, meshes[4], servo_vals[4], y_axis, 150.0},
-        {nullptr, nullptr, servo_vals[5], z_axis, 0},
-        {nullptr, nullptr, servo_vals[6], z_axis, 0}
-    };
-
-    for (int i = 0; i < sizeof mesh_locs / sizeof mesh_locs[0]; i++)
-        if (meshes[i]->loadObj(mesh_locs[i]))
-            handle_error((std::string("Failed to load model: ") + mesh_locs[i]).c_str());
+    if (robots[0]->chain.load_meshes())
+        handle_error("Failed to load robot meshes");
 
-    for (int i = 0; i < sizeof segment_vals / sizeof segment_vals[0]; i++)
-        new (segments[i]) segment_t(segment_vals[i]);
+    watch_resources();
 
     reset();
     uiHandler->load();
     //debugInfo->load();
 
-    joysticks->query_joysticks();
-    robot_interface->open(1155, 22352);
+    if (!headless && !(input_record && input_record->playback))
+        joysticks->query_joysticks();
+
+    for (auto *robot : robots)
+        robot->connect(*robot_description);
+
     set_segments_from_robot();
     if (debug_pedantic)
         fprintf(stderr, "robot_target: %lf %lf %lf\n", robot_target[0], robot_target[1], robot_target[2]);
@@ -1549,20 +1150,321 @@ textFragmentShader->load("shaders/text_fragment_shader.glsl"))
     return glsuccess;
 }
 
-int main() {
-    if (init_context() || init() || load())
-        handle_error("Failed to load", glfail);
+void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n\
+  --headless            render offscreen through EGL, no window or input\n\
+  --no-render           headless control only, skip all drawing\n\
+  --frames N            exit after N frames\n\
+  --dump-frames PREFIX  write each headless frame to PREFIX000000.ppm\n\
+  --benchmark N         run a scripted benchmark for N frames, vsync off\n\
+  --benchmark-out PATH  benchmark JSON output, default benchmark.json\n\
+  --trace PATH          write a Chrome trace at exit, needs a -DPROFILE=ON build\n\
+  --tick-rate HZ        simulation tick rate, default 240\n\
+  --on-demand           redraw only on input, motion or UI changes\n\
+  --robot PATH          robot description, default assets/xarm.robot\n\
+  --serial SERIAL       open the robot with this USB serial, repeat for more robots\n\
+  --record PATH         record keyboard and gamepad input to PATH\n\
+  --playback PATH       replay a recording in place of live input, benchmarked\n\
+  --no-collision        accept IK solutions that collide\n\
+  --ik-network PATH     load IK network weights, used where the geometric IK fails\n\
+  --ik-train PATH       train the IK network on the robot's kinematics, save it to PATH\n\
+  --ik-benchmark N      time N random targets through the geometric IK and the network, then exit\n\
+  --debug               start with debug drawing enabled\n", program);
+}
 
-    while (!glfwWindowShouldClose(window)) {
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+int parse_arguments(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
 
-        frametime.update();
-        auto delta_time = frametime.get_delta_time<double>();
+        if (arg == "--headless") {
+            headless = true;
+        } else
+        if (arg == "--no-render") {
+            headless = true;
+            render_enabled = false;
+        } else
+        if (arg == "--frames" && has_value) {
+            frame_limit = atol(argv[++i]);
+        } else
+        if (arg == "--dump-frames" && has_value) {
+            headless = true;
+            frame_dump_prefix = argv[++i];
+        } else
+        if (arg == "--benchmark" && has_value) {
+            benchmark = new gui::benchmark_t(atoi(argv[++i]));
+        } else
+        if (arg == "--benchmark-out" && has_value) {
+            benchmark_path = argv[++i];
+        } else
+        if (arg == "--trace" && has_value) {
+            trace_path = argv[++i];
+
+            if (!gui::profiler_t::enabled)
+                fprintf(stderr, "Profiling not compiled in, --trace ignored\n");
+        } else
+        if (arg == "--tick-rate" && has_value) {
+            sim_clock_t::tick_rate = std::max(atof(argv[++i]), 1.0);
+        } else
+        if (arg == "--on-demand") {
+            on_demand = true;
+        } else
+        if (arg == "--robot" && has_value) {
+            robot_path = argv[++i];
+        } else
+        if (arg == "--serial" && has_value) {
+            std::string serial = argv[++i];
+            robot_serials.push_back(std::wstring(serial.begin(), serial.end()));
+        } else
+        if (arg == "--record" && has_value) {
+            input_record = new input_record_t();
+
+            if (input_record->open_record(argv[++i], sim_clock_t::tick_rate))
+                return glfail;
+        } else
+        if (arg == "--playback" && has_value) {
+            input_record = new input_record_t();
+
+            if (input_record->open_playback(argv[++i]))
+                return glfail;
+        } else
+        if (arg == "--no-collision") {
+            collision_checking = false;
+        } else
+        if (arg == "--ik-network" && has_value) {
+            ik_network_path = argv[++i];
+        } else
+        if (arg == "--ik-train" && has_value) {
+            ik_train_path = argv[++i];
+        } else
+        if (arg == "--ik-benchmark" && has_value) {
+            ik_benchmark_count = std::max(atoi(argv[++i]), 1);
+        } else
+        if (arg == "--debug") {
+            debug_mode = true;
+        } else {
+            print_usage(argv[0]);
+            return glfail;
+        }
+    }
+
+    if (input_record && !input_record->playback) {
+        // Flag order should not matter, the header takes the final tick rate
+        input_record->header.tick_rate = sim_clock_t::tick_rate;
+    }
+
+    if (input_record && input_record->playback) {
+        // Ticks only line up at the rate they were recorded at
+        sim_clock_t::tick_rate = input_record->header.tick_rate;
+
+        if (!benchmark)
+            benchmark = new gui::benchmark_t(input_record->header.frames, 0);
+    }
+
+    return glsuccess;
+}
+
+void benchmark_script(double time) {
+    static const vec3_d rest_target = robot_target;
+
+    // Orbit the camera around the base every 20 seconds
+    float angle = time * 2.0 * M_PI / 20.0;
+    camera->position = glm::vec3(std::cos(angle) * 35.0f, 20.0f, std::sin(angle) * 35.0f);
+
+    auto look = glm::normalize(-camera->position);
+    camera->yaw = glm::degrees(std::atan2(look.z, look.x));
+    camera->pitch = glm::degrees(std::asin(look.y));
+    camera->calculate_normals();
+
+    // Sweep the end effector through a loop around its rest position
+    robot_target = rest_target + vec3_d(5.0 * std::cos(time * 2.0), 5.0 * std::sin(time * 3.0), 5.0 * std::sin(time * 2.0));
+    kinematics->solve_inverse(robot_target);
+}
+
+bool finish_benchmark() {
+    const char *renderer = (const char*)glGetString(GL_RENDERER);
+
+    if (benchmark->write_json(benchmark_path, renderer))
+        return glfail;
+
+    auto frame = benchmark->get_stats(gui::BENCH_FRAME);
+
+    fprintf(stderr, "Benchmark %i frames on %s, mean %.3f ms, p99 %.3f ms, %lu IK solves, %lu servo commands, written to %s\n",
+        (int)benchmark->samples[gui::BENCH_FRAME].size(), renderer, frame.mean, frame.p99,
+        (unsigned long)benchmark->counters[gui::COUNT_IK_SOLVES], (unsigned long)benchmark->counters[gui::COUNT_SERVO_COMMANDS], benchmark_path);
+
+    return glsuccess;
+}
+
+// Joint ranges of a chain's IK joints in degrees, the root does not turn
+void get_ik_limits(robot_chain_t *chain, float *min_degrees, float *max_degrees) {
+    min_degrees[0] = max_degrees[0] = 0.0f;
+
+    for (int i = 1; i < ik_network_t::joints; i++) {
+        auto *segment = chain->ik[i];
+        min_degrees[i] = segment->get_servo_degrees(segment->servo_min);
+        max_degrees[i] = segment->get_servo_degrees(segment->servo_max);
+
+        if (min_degrees[i] > max_degrees[i])
+            std::swap(min_degrees[i], max_degrees[i]);
+    }
+}
+
+bool load_ik_network() {
+    if (!robot_chain->fixed_xarm) {
+        fprintf(stderr, "The IK network is built for the xArm chain, %s does not match it\n", robot_path);
+        return glfail;
+    }
+
+    ik_network = new ik_network_t();
+
+    for (auto *robot : robots)
+        robot->kinematics.network = ik_network;
+
+    if (!ik_train_path)
+        return ik_network->load(ik_network_path);
+
+    constexpr int samples = 200000;
+    float min_degrees[ik_network_t::joints], max_degrees[ik_network_t::joints];
+    get_ik_limits(robot_chain, min_degrees, max_degrees);
+
+    ik_dataset_t data;
+    data.generate(min_degrees, max_degrees, samples);
+
+    ik_trainer_t trainer;
+    trainer.verbose = debug_mode;
+
+    auto begin = std::chrono::steady_clock::now();
+    float loss = trainer.train(*ik_network, data);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    fprintf(stderr, "IK network trained on %i samples in %.1f s, loss %g, written to %s\n", samples, seconds, loss, ik_train_path);
+
+    return ik_network->save(ik_train_path);
+}
+
+/*
+Geometric IK against the network on the same random targets, forward
+kinematics of random angles in the network's range. Every geometric
+solve starts from the same pose with collision checks off, the network
+is given each target's pitch, the geometric solver picks its own.
+*/
+void run_ik_benchmark(int count) {
+    using clk = std::chrono::steady_clock;
+
+    float min_degrees[ik_network_t::joints], max_degrees[ik_network_t::joints];
+    get_ik_limits(robot_chain, min_degrees, max_degrees);
+
+    ik_dataset_t targets;
+    targets.generate(min_degrees, max_degrees, count, 7);
+
+    const glm::vec3 root = robot_chain->ik[0]->get_origin(false);
+
+    struct result_t {
+        double ns = 0.0, error = 0.0, max_error = 0.0;
+        int failed = 0, solved = 0;
+
+        void add(float e, bool ok) {
+            if (!ok) {
+                failed++;
+                return;
+            }
+
+            solved++;
+            error += e;
+            max_error = std::max<double>(max_error, e);
+        }
+
+        void print(const char *name, int count) {
+            printf("%-22s %10.1f %10.4f %10.4f %8i\n", name, ns / count, solved ? error / solved : 0.0, max_error, failed);
+        }
+    };
+
+    auto target = [&](int i) {
+        return root + glm::vec3(targets.input[i * 4], targets.input[i * 4 + 1], targets.input[i * 4 + 2]);
+    };
+
+    result_t geometric, predicted, refined;
+
+    {
+        auto &st = robot_chain->state;
+        int prev_end[chain_state_t::capacity], prev_cur[chain_state_t::capacity];
+        segment_t::tp prev_command[chain_state_t::capacity];
+
+        std::copy_n(st.servo_end_position, st.count, prev_end);
+        std::copy_n(st.servo_cur_position, st.count, prev_cur);
+        std::copy_n(st.last_command, st.count, prev_command);
+
+        bool checking = kinematics->collision_checking;
+        ik_network_t *network = kinematics->network;
+        kinematics->collision_checking = false;
+        kinematics->network = nullptr;
+
+        for (int i = 0; i < count; i++) {
+            std::copy_n(prev_end, st.count, st.servo_end_position);
+            std::copy_n(prev_cur, st.count, st.servo_cur_position);
+            std::copy_n(prev_command, st.count, st.last_command);
+
+            auto begin = clk::now();
+            bool failed = kinematics->solve_inverse(target(i));
+            geometric.ns += std::chrono::duration<double, std::nano>(clk::now() - begin).count();
+
+            geometric.add(glm::distance(robot_chain->get_tip(false), target(i)), !failed);
+        }
 
-        handle_keyboard(window, delta_time);
-        joysticks->update(delta_time * 60.0);
-        robot_interface->update();
+        std::copy_n(prev_end, st.count, st.servo_end_position);
+        std::copy_n(prev_cur, st.count, st.servo_cur_position);
+        std::copy_n(prev_command, st.count, st.last_command);
+
+        kinematics->collision_checking = checking;
+        kinematics->network = network;
+    }
+
+    if (ik_network) {
+        std::vector<float> degrees(count * ik_network_t::joints);
+
+        auto begin = clk::now();
+        for (int i = 0; i < count; i++)
+            ik_network->predict(target(i) - root, targets.input[i * 4 + 3], &degrees[i * ik_network_t::joints]);
+        predicted.ns = std::chrono::duration<double, std::nano>(clk::now() - begin).count();
+
+        for (int i = 0; i < count; i++) {
+            xarm_chain_t::pose_t pose;
+            xarm_chain_t::forward(root, &degrees[i * ik_network_t::joints], pose);
+
+            float error = glm::distance(pose.tip, target(i));
+            predicted.add(error, error <= kinematics_t::network_tolerance);
+        }
+
+        std::vector<float> errors(count);
+
+        begin = clk::now();
+        for (int i = 0; i < count; i++)
+            errors[i] = ik_network->solve(root, target(i), targets.input[i * 4 + 3], &degrees[i * ik_network_t::joints]);
+        refined.ns = std::chrono::duration<double, std::nano>(clk::now() - begin).count();
+
+        for (int i = 0; i < count; i++)
+            refined.add(errors[i], errors[i] <= kinematics_t::network_tolerance);
+    }
+
+    printf("%i targets, tip error in world units\n", count);
+    printf("%-22s %10s %10s %10s %8s\n", "path", "ns/solve", "mean", "max", "failed");
+    geometric.print("solve_inverse", count);
+
+    if (ik_network) {
+        predicted.print("network", count);
+        refined.print("network + refine", count);
+    }
+}
+
+bool render_frame() {
+    using scope_t = gui::benchmark_t::scope_t;
+
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    {
+        scope_t scope(benchmark, gui::BENCH_SEGMENTS);
 
         mainProgram->use();
         //mainProgram->set_camera(camera);
@@ -1579,30 +1481,253 @@ int main() {
 
         mainProgram->set_material(robotMaterial);
 
+        gpu_timer_t::scope_t gpu_scope(gpu_timer, GPU_PASS_SEGMENTS);
         render::render_segments(visible_segments, mainProgram, camera, model_interpolation);
+    }
 
-        if (debug_mode)
-            debug_objects->render();    
-        
-        if (uiHandler->render())
+    if (debug_mode) {
+        scope_t scope(benchmark, gui::BENCH_DEBUG);
+        gpu_timer_t::scope_t gpu_scope(gpu_timer, GPU_PASS_DEBUG);
+        debug_objects->render(camera);    
+    }
+
+    scope_t scope(benchmark, gui::BENCH_UI);
+    gpu_timer_t::scope_t gpu_scope(gpu_timer, GPU_PASS_UI);
+    return ui_cache->render(uiHandler, ui_batcher);
+}
+
+// Keys whose press acts on the simulation, recorded so playback repeats them
+void key_action(int key) {
+    switch (key) {
+    case GLFW_KEY_X:
+        joysticks->query_robot();
+        break;
+    case GLFW_KEY_B:
+        robot_interface->servos_off();
+        break;
+    case GLFW_KEY_TAB:
+        select_robot(active_robot + 1);
+        break;
+    }
+}
+
+// Polls live devices and records them, or replaces them with the recording
+void poll_input(double time) {
+    static input_tick_t tick;
+
+    if (!input_record || !input_record->playback) {
+        joysticks->poll();
+
+        if (!input_record)
+            return;
+
+        tick.time = time;
+
+        for (int w = 0; w < tick.key_words; w++) {
+            tick.keys[w] = 0;
+            for (int b = 0; b < 64; b++)
+                tick.keys[w] |= uint64_t(input->keys[w * 64 + b]) << b;
+        }
+
+        joysticks->capture(tick);
+        input_record->sync_tick(tick);
+        return;
+    }
+
+    if (!input_record->sync_tick(tick))
+        return;
+
+    for (int w = 0; w < tick.key_words; w++)
+        for (int b = 0; b < 64; b++)
+            input->keys[w * 64 + b] = (tick.keys[w] >> b) & 1;
+
+    for (int i = 0; i < tick.press_count; i++)
+        key_action(tick.presses[i]);
+
+    joysticks->apply(tick);
+}
+
+// On demand mode draws only when something visible could have changed
+bool needs_redraw() {
+    struct view_state_t {
+        glm::vec3 position;
+        float yaw, pitch, fov;
+        int servos[8];
+    };
+
+    static view_state_t drawn = {};
+    view_state_t current = {camera->position, camera->yaw, camera->pitch, camera->fov, {0}};
+
+    bool moving = false;
+
+    for (int i = 0; i < robot_chain->servos.size() && i < 8; i++)
+        current.servos[i] = robot_chain->servos[i]->get_servo();
+
+    for (auto *robot : robots)
+        for (auto *seg : robot->chain.servos)
+            moving |= !seg->movement_complete();
+
+    bool changed = memcmp(&current, &drawn, sizeof current) != 0;
+    drawn = current;
+
+    bool redraw = redraw_requested || moving || changed || input->keys.any() || ui_cache->dirty || uiHandler->is_dirty();
+    redraw_requested = false;
+
+    return redraw;
+}
+
+int main(int argc, char **argv) {
+    using scope_t = gui::benchmark_t::scope_t;
+
+    if (parse_arguments(argc, argv))
+        return 1;
+
+    if (init_context() || init() || load())
+        handle_error("Failed to load", glfail);
+
+    if ((ik_network_path || ik_train_path) && load_ik_network())
+        handle_error("Failed to load the IK network", glfail);
+
+    if (ik_benchmark_count > 0) {
+        run_ik_benchmark(ik_benchmark_count);
+        safe_exit(0);
+    }
+
+    long frame = 0;
+    bool idle = false;
+
+    while (!should_exit()) {
+        gui::profiler_t::frame();
+        PROFILE_SCOPE("frame");
+
+        frametime.update();
+        auto delta_time = benchmark ? benchmark->dt : frametime.get_delta_time<double>();
+
+        // Time spent waiting for events is not simulated
+        if (idle)
+            delta_time = std::min(delta_time, 1.0 / 60.0);
+
+        // Recording ended before the benchmark frame count, report what was replayed
+        if (input_record && !input_record->begin_frame(delta_time)) {
+            if (benchmark && finish_benchmark())
+                handle_error("Failed to write benchmark results");
             break;
+        }
+
+        file_watcher->update();
+        input->dispatch();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        sim_clock_t::advance(delta_time);
+
+        if (benchmark && !input_record) {
+            scope_t scope(benchmark, gui::BENCH_IK);
+            benchmark_script(benchmark->get_time());
+        }
+
+        // Jogging, IK targets and servo commands advance at the fixed tick rate
+        while (sim_clock_t::step()) {
+            const double tick_time = sim_clock_t::get_dt();
+
+            if (benchmark)
+                benchmark->count(gui::COUNT_TICKS);
+
+            if (!headless || input_record) {
+                scope_t scope(benchmark, gui::BENCH_INPUT);
+                poll_input(std::chrono::duration<double>(sim_clock_t::time).count());
+                handle_keyboard(window, tick_time);
+                joysticks->update(tick_time * 60.0);
+            }
+
+            scope_t scope(benchmark, gui::BENCH_ROBOT);
+            for (auto *robot : robots)
+                robot->interface.update();
+        }
+
+        sim_clock_t::begin_render();
+
+        bool draw = !on_demand || headless || benchmark || needs_redraw();
+
+        if (render_enabled && draw) {
+            if (render_frame())
+                break;
+
+            gpu_timer->end_frame();
+        }
+
+        {
+            scope_t scope(benchmark, gui::BENCH_SWAP);
+
+            if (headless) {
+                // Nothing paces a control-only loop, run it near display rate
+                if (render_enabled)
+                    headless_context->swap();
+                else if (!benchmark)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            } else {
+                if (draw)
+                    glfwSwapBuffers(window);
+
+                // Gamepads raise no events, keep polling them at display rate
+                idle = !draw;
+                if (idle)
+                    glfwWaitEventsTimeout(joysticks->connected_count > 0 ? 1.0 / 60.0 : 0.5);
+                else
+                    glfwPollEvents();
+            }
+
+            // Charge outstanding GPU work to this frame
+            if (benchmark && render_enabled)
+                glFinish();
+        }
+
+        if (benchmark) {
+            benchmark->end_frame();
+
+            if (benchmark->is_done()) {
+                if (finish_benchmark())
+                    handle_error("Failed to write benchmark results");
+                hint_exit();
+            }
+        }
+
+        if (frame_limit > 0 && ++frame >= frame_limit)
+            hint_exit();
     }
 
     safe_exit(0);
 }
 
 void destroy() {
-    glfwTerminate();
+    if (trace_path && gui::profiler_t::enabled)
+        gui::profiler_t::write_chrome_trace(trace_path);
+
+    if (input_record)
+        input_record->close();
+
+    if (headless_context)
+        headless_context->destroy();
+    else
+        glfwTerminate();
+
+    for (auto *robot : robots)
+        robot->interface.destroy();
 
-    if (robot_interface)
-        robot_interface->destroy();
+    hid_exit();
 }
 
 void hint_exit() {
-    glfwSetWindowShouldClose(window, 1);
+    exit_requested = true;
+
+    if (window)
+        glfwSetWindowShouldClose(window, 1);
+}
+
+void request_redraw() {
+    redraw_requested = true;
+}
+
+bool should_exit() {
+    return exit_requested || (window && glfwWindowShouldClose(window));
 }
 
 void safe_exit(int errcode) {
@@ -1620,25 +1745,96 @@ void handle_signal(int sig) {
     hint_exit();
 }
 
+gui::events::KeyboardEvents input_action(int action) {
+    using namespace gui::events;
+
+    if (action == GLFW_PRESS)
+        return PRESS;
+    if (action == GLFW_REPEAT)
+        return HOLD;
+    return RELEASE;
+}
+
+// GLFW callbacks only queue, handlers run from input->dispatch() at the start of the frame
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
-    current_window[2] = width;
-    current_window[3] = height;
-    glViewport(0, 0, width, height);
-    uiHandler->onFramebuffer(width, height);
+    input->post({gui::events::FRAMEBUFFER, 0, 0, 0, double(width), double(height)});
+    request_redraw();
 }
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods) {
-    if (uiHandler->onMouse(button, action, mods))
-        return;
-
-    camera->mousePress(window, button, action, mods);
+    input->post({gui::events::MOUSE_BUTTON, button, input_action(action), mods, 0, 0});
+    request_redraw();
 }
 
 void cursor_position_callback(GLFWwindow *window, double x, double y) {
-    if (uiHandler->onCursor(x, y))
-        return;
+    input->post({gui::events::CURSOR, 0, 0, 0, x, y});
+    request_redraw();
+}
 
-    camera->mouseMove(window, x, y);
+bool key_down(int key) {
+    return input && input->is_down(key);
+}
+
+void register_input() {
+    using namespace gui::events;
+
+    input->subscribe(FRAMEBUFFER, [](const InputEvent &e) {
+        int width = e.x, height = e.y;
+        current_window[2] = width;
+        current_window[3] = height;
+        glViewport(0, 0, width, height);
+        ui_cache->resize(width, height);
+        uiHandler->onFramebuffer(width, height);
+    });
+
+    input->subscribe(MOUSE_BUTTON, [](const InputEvent &e) {
+        int action = e.action == PRESS ? GLFW_PRESS : GLFW_RELEASE;
+
+        if (uiHandler->onMouse(e.code, action, e.mods))
+            return;
+
+        camera->mousePress(window, e.code, action, e.mods);
+    });
+
+    input->subscribe(CURSOR, [](const InputEvent &e) {
+        if (uiHandler->onCursor(e.x, e.y))
+            return;
+
+        camera->mouseMove(window, e.x, e.y);
+    });
+
+    input->subscribe(JOYSTICK, [](const InputEvent &e) {
+        if (input_record && input_record->playback)
+            return;
+
+        joysticks->query_joysticks();
+    });
+
+    input->on_press(GLFW_KEY_ESCAPE, [](const InputEvent &e) {
+        hint_exit();
+    });
+
+    input->on_press(GLFW_KEY_F11, [](const InputEvent &e) {
+        toggle_fullscreen_state();
+    });
+
+    // Playback runs these from the recording instead, UI that takes the keyboard suppresses them as handle_keyboard does
+    auto action = [](const InputEvent &e) {
+        if (input_record && input_record->playback)
+            return;
+
+        if (uiHandler->onKeyboard(0.0f))
+            return;
+
+        key_action(e.code);
+
+        if (input_record)
+            input_record->press(e.code);
+    };
+
+    input->on_press(GLFW_KEY_X, action);
+    input->on_press(GLFW_KEY_B, action);
+    input->on_press(GLFW_KEY_TAB, action);
 }
 
 void toggle_fullscreen_state() {
@@ -1669,58 +1865,39 @@ void toggle_fullscreen_state() {
     }
 }
 
+// Continuous actions for held keys, one shot actions are press handlers in register_input
 void handle_keyboard(GLFWwindow* window, float deltaTime) {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-        hint_exit();
-        return;
-    }
-
-    if (glfwGetKey(window, GLFW_KEY_F11))
-        toggle_fullscreen_state();
-
     if (uiHandler->onKeyboard(deltaTime))
         return;
 
-    static bool x_press = false;
-    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS) {
-        if (!x_press)
-            joysticks->query_robot();
-        x_press = true;
-    } else {
-        x_press = false;
-    }
-
-    static bool b_press = false;
-    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS) {
-        if (!b_press)
-            robot_interface->servos_off();
-        b_press = true;
-    } else {
-        b_press = false;
-    }
-
     camera->keyboard(window, deltaTime);
 
+    // Jog keys go to the servo driven IK joints in chain order
     int raise[] = {GLFW_KEY_R, GLFW_KEY_T, GLFW_KEY_Y, GLFW_KEY_U};
     int lower[] = {GLFW_KEY_F, GLFW_KEY_G, GLFW_KEY_H, GLFW_KEY_J};
-    segment_t *segments[] = {s6,s5,s4,s3};
+    auto &ik = robot_chain->ik;
 
     float movementFactor = movementSpeed;
-    if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
+    if (key_down(GLFW_KEY_LEFT_CONTROL))
         movementFactor = rapidSpeed;
 
     bool change_2 = false;
 
-    for (int i = 0; i < 4; i++) {
-        auto *seg = segments[i];
+    for (int i = 0, k = 0; i < ik.size() && k < 4; i++) {
+        auto *seg = ik[i];
+
+        if (seg->servo_num < 1)
+            continue;
+
+        const int key = k++;
         auto rot = seg->get_rotation(false);
-        if (glfwGetKey(window, raise[i]) == GLFW_PRESS) {
+        if (key_down(raise[key])) {
             rot += movementFactor * deltaTime;
             seg->set_rotation(rot);
             change_2 = true;
         }
 
-        if (glfwGetKey(window, lower[i]) == GLFW_PRESS) {
+        if (key_down(lower[key])) {
             rot -= movementFactor * deltaTime;
             seg->set_rotation(rot);
             change_2 = true;
@@ -1728,7 +1905,7 @@ void handle_keyboard(GLFWwindow* window, float deltaTime) {
     }
 
     if (change_2) {
-        robot_target = s3->get_segment_vector() + s3->get_origin();
+        robot_target = robot_chain->get_tip();
         set_sliders_from_segments();
     }
 
@@ -1737,7 +1914,7 @@ void handle_keyboard(GLFWwindow* window, float deltaTime) {
     bool change = false;
 
     for (int i = 0; i < 6; i++) {
-        robot3d_o[i] = (glfwGetKey(window, robot3d[i]) == GLFW_PRESS);
+        robot3d_o[i] = key_down(robot3d[i]);
 
         if (robot3d_o[i]) {
             change = true;
@@ -1770,6 +1947,12 @@ void handle_keyboard(GLFWwindow* window, float deltaTime) {
     }
 }
 
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    input->post({gui::events::KEY, key, input_action(action), mods, 0, 0});
+    request_redraw();
+}
+
 void joystick_callback(int jid, int event) {
-    joysticks->query_joysticks();
+    input->post_async({gui::events::JOYSTICK, jid, event, 0, 0, 0});
+    request_redraw();
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <assert.h>
+
 #include "mesh.h"
 
 mesh_t::mesh_t():
@@ -7,14 +9,13 @@ mesh_t::mesh_t():
         modified(0),
         position(0.0f) {
     clear();
-
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
 }
 
 mesh_t::~mesh_t() {
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
+    if (vbo)
+        glDeleteBuffers(1, &vbo);
+    if (vao)
+        glDeleteVertexArrays(1, &vao);
 }
 
 void mesh_t::clear() {
@@ -39,6 +40,12 @@ void mesh_t::mesh() {
         return;
     }
 
+    // Created on the first upload, loading and collision need no GL context
+    if (!vao) {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+    }
+
     glBindVertexArray(vao);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, vertexCount * stride, verticies.data(), GL_STATIC_DRAW);
@@ -267,5 +274,18 @@ shape count: %i\n",
     if (debug_mode)
         fprintf(stderr, "Final verticies: %i\n", vertexCount);
 
+    return glsuccess;
+}
+
+bool mesh_t::reloadObj(const char *filepath) {
+    std::vector<vertex_t> previous;
+    previous.swap(verticies);
+
+    if (loadObj(filepath)) {
+        verticies.swap(previous);
+        vertexCount = verticies.size();
+        return glfail;
+    }
+
     return glsuccess;
 }
\ No newline at end of file
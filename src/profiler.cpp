@@ -0,0 +1,136 @@
+#include <errno.h>
+
+#include "profiler.h"
+#include "util.h"
+
+namespace gui {
+
+::tp profiler_t::epoch = hrc::now();
+uint64_t profiler_t::frame_start = 0;
+uint64_t profiler_t::last_frame_start = 0;
+std::mutex profiler_t::threads_lock;
+std::vector<profile_thread_t*> profiler_t::threads;
+
+profile_thread_t &profiler_t::get_thread() {
+    // Rings outlive their threads so the trace can still be written at exit
+    thread_local profile_thread_t *thread = [] {
+        auto *created = new profile_thread_t();
+        created->count = 0;
+        created->depth = 0;
+
+        std::lock_guard lock(threads_lock);
+        created->id = threads.size();
+        threads.push_back(created);
+
+        return created;
+    }();
+
+    return *thread;
+}
+
+void profiler_t::timeline(char *buffer, const size_t &size, size_t &offset, int width) {
+    struct merged_t {
+        const char *name;
+        uint32_t depth, calls;
+        uint64_t first, last, total;
+    };
+
+    // Only the calling thread writes this ring, reading it here is safe
+    auto &thread = get_thread();
+    const uint64_t span = frame_start - last_frame_start;
+
+    if (span < 1)
+        return;
+
+    merged_t merged[64];
+    int merged_count = 0;
+
+    uint64_t count = thread.count.load(std::memory_order_acquire);
+    uint64_t oldest = count > profile_thread_t::capacity ? count - profile_thread_t::capacity : 0;
+
+    for (uint64_t i = oldest; i < count; i++) {
+        auto &zone = thread.zones[i % profile_thread_t::capacity];
+
+        if (zone.start < last_frame_start || zone.end > frame_start)
+            continue;
+
+        merged_t *entry = nullptr;
+
+        for (int k = 0; k < merged_count; k++)
+            if (merged[k].depth == zone.depth && !strcmp(merged[k].name, zone.name))
+                entry = &merged[k];
+
+        if (!entry) {
+            if (merged_count >= 64)
+                continue;
+
+            entry = &merged[merged_count++];
+            *entry = {zone.name, zone.depth, 0, zone.start, zone.end, 0};
+        }
+
+        entry->calls++;
+        entry->first = std::min(entry->first, zone.start);
+        entry->last = std::max(entry->last, zone.end);
+        entry->total += zone.end - zone.start;
+    }
+
+    std::sort(&merged[0], &merged[merged_count], [](const merged_t &a, const merged_t &b) {
+        return a.first < b.first || (a.first == b.first && a.depth < b.depth);
+    });
+
+    util::format_to(buffer, size, offset, "Profile {:.2f} ms\n", span / 1e6);
+
+    char bar[128];
+    width = std::clamp(width, 1, (int)sizeof bar - 1);
+
+    for (int i = 0; i < merged_count; i++) {
+        auto &entry = merged[i];
+        int from = (entry.first - last_frame_start) * width / span;
+        int to = std::max<int>((entry.last - last_frame_start) * width / span, from + 1);
+
+        for (int x = 0; x < width; x++)
+            bar[x] = (x >= from && x < std::min(to, width)) ? '#' : '.';
+        bar[width] = '\0';
+
+        util::format_to(buffer, size, offset, "{} {:>{}}{:<{}} {:>3}x {:>6.3f} ms\n",
+            (const char*)bar, "", entry.depth, entry.name, 24 - std::min<int>(entry.depth, 8),
+            entry.calls, entry.total / 1e6);
+    }
+}
+
+bool profiler_t::write_chrome_trace(const char *path) {
+    FILE *file = fopen(path, "w");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+    std::lock_guard lock(threads_lock);
+
+    for (auto *thread : threads) {
+        uint64_t count = thread->count.load(std::memory_order_acquire);
+        uint64_t oldest = count > profile_thread_t::capacity ? count - profile_thread_t::capacity : 0;
+
+        for (uint64_t i = oldest; i < count; i++) {
+            auto &zone = thread->zones[i % profile_thread_t::capacity];
+
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", zone.name, thread->id, zone.start / 1e3, (zone.end - zone.start) / 1e3);
+
+            first = false;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    fprintf(stderr, "Wrote trace of %i threads to %s\n", (int)threads.size(), path);
+
+    return glsuccess;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include <algorithm>
+
+#include "robot_description.h"
+#include "mesh.h"
+#include "profiler.h"
+
+robot_chain_t::robot_chain_t():
+        tip(nullptr),
+        owns_meshes(true),
+        fixed_xarm(false) {
+
+}
+
+robot_chain_t::~robot_chain_t() {
+    clear();
+}
+
+void robot_chain_t::clear() {
+    if (owns_meshes) {
+        for (auto *mesh : meshes)
+            delete mesh;
+
+        for (auto *bvh : bvhs)
+            delete bvh;
+    }
+
+    state.clear();
+    segments.clear();
+    meshes.clear();
+    bvhs.clear();
+    mesh_paths.clear();
+    roles.clear();
+    visible.clear();
+    servos.clear();
+    ik.clear();
+    tip = nullptr;
+    fixed_xarm = false;
+}
+
+bool robot_chain_t::compile(const robot_description_t &description, const robot_chain_t *shared) {
+    const auto &joints = description.joints;
+
+    clear();
+
+    // Reserved up front, parents and views point into this array
+    segments.reserve(joints.size());
+    owns_meshes = !shared;
+
+    if (joints.size() > chain_state_t::capacity) {
+        fprintf(stderr, "Error: %s: %i joints, at most %i are supported\n", description.path.c_str(), (int)joints.size(), chain_state_t::capacity);
+        return glfail;
+    }
+
+    for (auto &joint : joints) {
+        segment_t *parent = nullptr;
+        mesh_t *mesh = nullptr;
+
+        if (!joint.parent.empty())
+            parent = &segments[description.find(joint.parent)];
+
+        if (!joint.mesh.empty()) {
+            bvhs.push_back(shared ? shared->bvhs[meshes.size()] : new collision_bvh_t);
+            mesh = meshes.emplace_back(shared ? shared->meshes[meshes.size()] : new mesh_t);
+            mesh_paths.push_back(joint.mesh);
+        }
+
+        int slot = state.add(joint.servo);
+        auto &segment = segments.emplace_back(parent, mesh, state, slot, joint.axis, joint.length, joint.offset);
+        segment.model_scale = description.model_scale;
+
+        if (mesh)
+            visible.push_back(&segment);
+
+        if (joint.servo.servo_num > 0)
+            servos.push_back(&segment);
+
+        if (joint.ik)
+            ik.push_back(&segment);
+
+        roles.push_back(joint.role);
+    }
+
+    if (!segments.front().mesh) {
+        fprintf(stderr, "Error: %s: the root joint needs a mesh to place it\n", description.path.c_str());
+        return glfail;
+    }
+
+    // Root, base yaw and at least one planar joint
+    if (ik.size() < 3) {
+        fprintf(stderr, "Error: %s: IK chain needs at least 3 joints, found %i\n", description.path.c_str(), (int)ik.size());
+        return glfail;
+    }
+
+    tip = ik.back();
+    scene = description.scene;
+    fixed_xarm = xarm_chain_t::matches(ik);
+
+    if (debug_mode)
+        fprintf(stderr, "%s: %s kinematics\n", description.path.c_str(), fixed_xarm ? "Fixed xArm" : "Generic");
+
+    return glsuccess;
+}
+
+bool robot_chain_t::load_meshes() {
+    if (!owns_meshes)
+        return glsuccess;
+
+    for (int i = 0; i < meshes.size(); i++) {
+        if (meshes[i]->loadObj(mesh_paths[i].c_str())) {
+            fprintf(stderr, "Failed to load model: %s\n", mesh_paths[i].c_str());
+            return glfail;
+        }
+
+        build_bvh(i);
+    }
+
+    return glsuccess;
+}
+
+void robot_chain_t::build_bvh(int mesh) {
+    PROFILE_SCOPE("robot_chain_t::build_bvh");
+
+    bvhs[mesh]->build(*meshes[mesh]);
+
+    if (debug_mode)
+        fprintf(stderr, "%s: %i triangles, %i BVH nodes\n", mesh_paths[mesh].c_str(), (int)bvhs[mesh]->triangles.size(), (int)bvhs[mesh]->nodes.size());
+}
+
+void robot_chain_t::pose(const float *degrees, glm::mat4 *transforms) const {
+    // Rotation and origin per segment, as segment_T computes them recursively
+    glm::mat4 rotations[chain_state_t::capacity];
+    glm::vec3 origins[chain_state_t::capacity];
+
+    for (int i = 0; i < segments.size(); i++) {
+        const auto &segment = segments[i];
+        const float scale = segment.model_scale;
+
+        if (!segment.parent) {
+            rotations[i] = glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(x_axis));
+            origins[i] = segment.mesh->position + segment.offset * scale;
+        } else {
+            const int p = segment.parent->joint;
+            const glm::mat4 &parent_rotation = rotations[p];
+
+            rotations[i] = glm::rotate(parent_rotation, glm::radians(degrees[i]), segment.rotation_axis);
+            origins[i] = origins[p] + util::matrix_to_vector(parent_rotation) * segment.parent->get_length();
+
+            if (segment.offset != glm::vec3(0.0f))
+                origins[i] += glm::vec3(parent_rotation * glm::vec4(segment.offset * scale, 0.0f));
+        }
+
+        transforms[i] = glm::scale(glm::translate(glm::mat4(1.0f), origins[i]) * rotations[i], glm::vec3(scale));
+    }
+}
+
+bool robot_chain_t::check_collision(const glm::mat4 *transforms, collision_contact_t *contact) const {
+    PROFILE_SCOPE("robot_chain_t::check_collision");
+
+    collision_checker_t checker;
+    checker.bodies.reserve(visible.size());
+
+    for (int i = 0; i < visible.size(); i++) {
+        auto *segment = visible[i];
+        auto found = std::find(visible.begin(), visible.begin() + i, segment->parent);
+        int parent = found == visible.begin() + i ? -1 : found - visible.begin();
+
+        // The root stands in the scene, it cannot move into it
+        checker.add(bvhs[i], transforms[segment->joint], parent, !segment->parent);
+    }
+
+    // Scene follows the root, in world units
+    const auto &root = segments.front();
+    const glm::vec3 origin = glm::vec3(transforms[0][3]);
+    collision_scene_t world = scene;
+
+    world.floor_height = origin.y + scene.floor_height * root.model_scale;
+
+    for (auto &box : world.boxes) {
+        box.min = origin + box.min * root.model_scale;
+        box.max = origin + box.max * root.model_scale;
+    }
+
+    return checker.check(world, contact);
+}
+
+bool robot_chain_t::check_collision(const bool &allow_interpolate, collision_contact_t *contact) const {
+    float degrees[chain_state_t::capacity];
+    glm::mat4 transforms[chain_state_t::capacity];
+
+    for (int i = 0; i < segments.size(); i++)
+        degrees[i] = segments[i].get_rotation(allow_interpolate);
+
+    pose(degrees, transforms);
+
+    return check_collision(transforms, contact);
+}
+
+segment_t *robot_chain_t::find_role(const std::string &role) {
+    for (int i = 0; i < roles.size(); i++)
+        if (roles[i] == role)
+            return &segments[i];
+
+    return nullptr;
+}
+
+segment_t *robot_chain_t::find_servo(int servo_num) const {
+    for (auto *segment : servos)
+        if (segment->servo_num == servo_num)
+            return segment;
+
+    return nullptr;
+}
+
+glm::vec3 robot_chain_t::get_tip(const bool &allow_interpolate) const {
+    if (fixed_xarm) {
+        xarm_chain_t::pose_t pose;
+        xarm_chain_t::forward(ik, allow_interpolate, pose);
+        return pose.tip;
+    }
+
+    return tip->get_origin(allow_interpolate) + tip->get_segment_vector(allow_interpolate);
+}
\ No newline at end of file
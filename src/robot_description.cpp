@@ -0,0 +1,154 @@
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "robot_description.h"
+
+robot_description_t::robot_description_t():
+        vendor_id(0),
+        product_id(0),
+        model_scale(0.1f) {
+
+}
+
+bool robot_description_t::load(const char *path) {
+    std::ifstream file(path);
+
+    if (!file.is_open()) {
+        fprintf(stderr, "Error: Opening robot description: %s\n", path);
+        return glfail;
+    }
+
+    this->path = path;
+    joints.clear();
+    scene = {};
+
+    std::string line;
+    int line_num = 0;
+
+    auto fail = [&](const char *reason) {
+        fprintf(stderr, "Error: %s:%i: %s\n", path, line_num, reason);
+        return glfail;
+    };
+
+    while (std::getline(file, line)) {
+        line_num++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream in(line);
+        std::string key;
+
+        if (!(in >> key))
+            continue;
+
+        if (key == "robot") {
+            in >> name;
+        } else
+        if (key == "hid") {
+            in >> vendor_id >> product_id;
+        } else
+        if (key == "scale") {
+            in >> model_scale;
+        } else
+        if (key == "floor") {
+            in >> scene.floor_height;
+            scene.has_floor = true;
+        } else
+        if (key == "box") {
+            collision_aabb_t box;
+            in >> box.min.x >> box.min.y >> box.min.z >> box.max.x >> box.max.y >> box.max.z;
+
+            if (glm::any(glm::greaterThan(box.min, box.max)))
+                return fail("Box minimum above its maximum");
+
+            scene.boxes.push_back(box);
+        } else
+        if (key == "joint") {
+            joint_description_t joint = {};
+            joint.servo = robot_servo_t(0, 0, 0, 0, 0, 0, 0.0f, 1.0f);
+            joint.axis = glm::vec3(z_axis);
+
+            if (!(in >> joint.name))
+                return fail("Joint without a name");
+
+            in >> joint.parent;
+
+            if (find(joint.name) > -1)
+                return fail("Duplicate joint name");
+
+            if (!joint.parent.empty() && find(joint.parent) < 0)
+                return fail("Parent joint must be declared first");
+
+            if (joint.parent.empty() && joints.size() > 0)
+                return fail("Only the first joint may be the root");
+
+            joints.push_back(joint);
+            continue;
+        } else {
+            if (joints.size() < 1)
+                return fail("Joint property before any joint");
+
+            auto &joint = joints.back();
+
+            if (key == "axis") {
+                std::string axis;
+                in >> axis;
+
+                if (axis == "x")
+                    joint.axis = glm::vec3(x_axis);
+                else
+                if (axis == "y")
+                    joint.axis = glm::vec3(y_axis);
+                else
+                if (axis == "z")
+                    joint.axis = glm::vec3(z_axis);
+                else {
+                    std::istringstream first(axis);
+
+                    if (!(first >> joint.axis.x))
+                        return fail("Axis must be x, y, z or three numbers");
+
+                    in >> joint.axis.y >> joint.axis.z;
+                }
+            } else
+            if (key == "length") {
+                in >> joint.length;
+            } else
+            if (key == "offset") {
+                in >> joint.offset.x >> joint.offset.y >> joint.offset.z;
+            } else
+            if (key == "servo") {
+                auto &sv = joint.servo;
+                in >> sv.servo_num >> sv.servo_min >> sv.servo_max >> sv.servo_home >> sv.degrees_per_second >> sv.steps_per_degree;
+                sv.servo_cur_position = sv.servo_end_position = sv.servo_home;
+            } else
+            if (key == "mesh") {
+                in >> joint.mesh;
+            } else
+            if (key == "role") {
+                in >> joint.role;
+            } else
+            if (key == "ik") {
+                joint.ik = true;
+            } else {
+                return fail(("Unknown directive " + key).c_str());
+            }
+        }
+
+        if (in.fail())
+            return fail(("Bad value for " + key).c_str());
+    }
+
+    if (joints.size() < 1)
+        return fail("No joints");
+
+    return glsuccess;
+}
+
+int robot_description_t::find(const std::string &joint) const {
+    for (int i = 0; i < joints.size(); i++)
+        if (joints[i].name == joint)
+            return i;
+
+    return -1;
+}
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include <unistd.h>
+#include <stdlib.h>
+
+#include "robot_interface.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "util.h"
+
+void robot_interface_t::get_servo_targets(const segment_t::tp &batch_time, int *target, int *interp, int *dist) {
+    auto &st = chain->state;
+    const int n = st.padded();
+    const int64_t now = batch_time.time_since_epoch().count();
+
+    // get_clamped_rotation back to steps and clipped, util::wrap done branch free
+    for (int i = 0; i < n; i++) {
+        float deg = float(st.servo_end_position[i] - st.servo_home[i]) * st.steps_per_degree[i];
+        deg += 360.0f * std::max(std::ceil((-180.0f - deg) / 360.0f), 0.0f);
+        deg -= 360.0f * std::max(std::ceil((deg - 180.0f) / 360.0f), 0.0f);
+
+        int t = int(deg * (1.0f / st.steps_per_degree[i])) + st.servo_home[i];
+        t = t < st.servo_min[i] ? st.servo_min[i] : t;
+        t = t > st.servo_max[i] ? st.servo_max[i] : t;
+        target[i] = t;
+    }
+
+    // Elapsed seconds, a pass of its own as 64 bit to float only vectorizes on wider targets
+    alignas(32) float elapsed[chain_state_t::capacity];
+
+    for (int i = 0; i < n; i++)
+        elapsed[i] = std::max(float(now - st.last_command[i].time_since_epoch().count()) * 1e-9f, 0.0f);
+
+    // get_servo_interpolated
+    for (int i = 0; i < n; i++) {
+        int d = st.servo_end_position[i] - st.servo_cur_position[i];
+        int md = int(elapsed[i] * st.degrees_per_second[i]);
+        int intp = d > 0 ? md : -md;
+        bool done = abs(d) < st.min_command_threshold[i] || abs(intp) > abs(d);
+        interp[i] = done ? st.servo_end_position[i] : intp + st.servo_cur_position[i];
+        dist[i] = target[i] - interp[i];
+    }
+}
+
+void robot_interface_t::update() {
+    PROFILE_SCOPE("robot_interface_t::update");
+
+    telemetry.drain([this](const telemetry_t &t) {
+        apply_telemetry(t);
+    });
+
+    if (!handle && !virtual_output)
+        return;
+
+    using sv_t = segment_t::servo_type;
+    using tp_t = segment_t::tp;
+    using clk_t = segment_t::clk;
+    using pair_t = std::pair<sv_t, sv_t>;
+
+    tp_t now_batch = clk_t::now();
+
+    int r_period = int(std::chrono::duration_cast<dur>(now_batch - last_batch).count()) + t_overlap;
+
+    if (!constant_speed && r_period < u_period)
+        return;
+
+    if (!constant_speed && r_period > m_period)
+        r_period = m_period;
+
+    auto &st = chain->state;
+    alignas(32) int target[chain_state_t::capacity];
+    alignas(32) int interp[chain_state_t::capacity];
+    alignas(32) int dist[chain_state_t::capacity];
+
+    get_servo_targets(now_batch, target, interp, dist);
+
+    pair_t cmds[chain_state_t::capacity];
+    int cmd_count = 0;
+
+    // Only joints that move need the scalar jerk compensation
+    for (int i = 0; i < st.count; i++) {
+        if (st.servo_num[i] < 1)
+            continue;
+
+        int targeti = target[i];
+        int intrp = interp[i];
+
+        st.last_command[i] = now_batch;
+
+        if (abs(dist[i]) < st.min_command_threshold[i] && abs(dist[i]) < 1) {
+            st.servo_end_position[i] = targeti;
+            st.servo_cur_position[i] = targeti;
+            continue;
+        }
+
+        auto mv = (r_period/1000.0) * st.degrees_per_second[i];
+        auto mvdist = st.servo_cur_position[i] - intrp;
+        auto accel = mvdist / mv;
+        auto jerk = (mvdist * mv) / mv;
+        auto rintrp = intrp;
+
+        if (abs(jerk) > mv / 2 && abs(mvdist) > 0) {
+            intrp += (mvdist * .5);
+        } else
+        if (abs(dist[i]) < mv / 2 && abs(jerk) < mv / 4) {
+            intrp = targeti;
+            if (debug_pedantic)
+                fprintf(stderr, "Force set targeti\n");
+        }
+
+        if (debug_pedantic)
+            fprintf(stderr, "Send constant time s%i (%i/initialp -> %i/rintrp (jerk comp %i/intrp)) (%i/mvdist) (%i/targeti) = %i/dist (%i r_period/ms %.2lf mv/intpersec) accel %.2f jerk %.2f\n", st.servo_num[i], st.servo_cur_position[i], rintrp, intrp, mvdist, targeti, dist[i], r_period, mv, accel, jerk);
+
+        st.servo_end_position[i] = targeti;
+        st.servo_cur_position[i] = intrp;
+
+        cmds[cmd_count++] = { st.servo_num[i], intrp };
+    }
+
+    if (cmd_count > 0) {
+        if (benchmark)
+            benchmark->count(gui::COUNT_SERVO_COMMANDS, cmd_count);
+
+        set_servos(cmds, cmd_count, r_period);
+        last_batch = now_batch;
+    }
+}
+
+robot_interface_t::robot_interface_t(robot_chain_t *chain, bool permit_virtual):
+        chain(chain),
+        virtual_output(permit_virtual),
+        last_batch(segment_t::clk::now()),
+        running(false),
+        wake(0) {
+    init();
+}
+
+robot_interface_t::~robot_interface_t() {
+    destroy();
+}
+
+void robot_interface_t::destroy() {
+    if (handle) {
+        if (servo_sleep_on_destroy)                
+            servos_off();
+        fprintf(stderr, "Close robot connection %s\n", serial_number.c_str());
+        close();
+    }
+}
+
+std::vector<std::wstring> robot_interface_t::enumerate(unsigned short vendor_id, unsigned short product_id) {
+    std::vector<std::wstring> serials;
+    hid_device_info *devices = hid_enumerate(vendor_id, product_id);
+
+    // A device can list several interfaces under one serial
+    for (auto *dev = devices; dev; dev = dev->next)
+        if (dev->serial_number && std::find(serials.begin(), serials.end(), dev->serial_number) == serials.end())
+            serials.push_back(dev->serial_number);
+
+    hid_free_enumeration(devices);
+
+    return serials;
+}
+
+void robot_interface_t::start() {
+    if (!handle || running)
+        return;
+
+    running = true;
+    worker = std::thread(&robot_interface_t::run, this);
+}
+
+void robot_interface_t::stop() {
+    if (!running)
+        return;
+
+    running = false;
+    wake.fetch_add(1, std::memory_order_release);
+    wake.notify_one();
+    worker.join();
+}
+
+void robot_interface_t::run() {
+    packet_t packet;
+
+    while (running.load(std::memory_order_acquire)) {
+        uint32_t seen = wake.load(std::memory_order_acquire);
+
+        while (packets.pop(packet))
+            transfer(packet, true);
+
+        wake.wait(seen, std::memory_order_acquire);
+    }
+
+    while (packets.pop(packet))
+        transfer(packet, true);
+}
+
+void robot_interface_t::send(const packet_t &packet) {
+    if (!running) {
+        transfer(packet, false);
+        return;
+    }
+
+    if (!packets.push(packet) && debug_mode)
+        fprintf(stderr, "Robot %s command queue full, dropped\n", serial_number.c_str());
+
+    wake.fetch_add(1, std::memory_order_release);
+    wake.notify_one();
+}
+
+void robot_interface_t::transfer(const packet_t &packet, bool from_worker) {
+    if (!handle)
+        return;
+
+    hid_write(handle, &packet.bytes[0], packet.size);
+
+    if (packet.delay_ms)
+        usleep(packet.delay_ms * 1000);
+
+    if (packet.type != packet_t::READ)
+        return;
+
+    unsigned char ret[100];
+    int count = hid_read_timeout(handle, &ret[0], 100, 2000);
+    telemetry_t t;
+    t.set_pos = packet.set_pos;
+
+    if (!robot_protocol::decode_positions(&ret[0], count, t)) {
+        if (debug_mode)
+            fprintf(stderr, "Failed to read any bytes\n%s\n", get_hid_error().c_str());
+        return;
+    }
+
+    if (!from_worker)
+        apply_telemetry(t);
+    else
+        telemetry.push(t);
+}
+
+void robot_interface_t::apply_telemetry(const telemetry_t &t) {
+    auto now_time = segment_t::clk::now();
+    for (int i = 0; i < t.count; i++) {
+        int id = t.ids[i];
+        auto *seg = chain->find_servo(id);
+        if (!seg)
+            continue;
+        seg->servo_cur_position = t.positions[i];
+        if (t.set_pos)
+            seg->servo_end_position = t.positions[i];
+        seg->last_command = now_time;
+        if (debug_pedantic)
+            fprintf(stderr, "s%i r%i p%i\n", id, seg->servo_cur_position, seg->servo_end_position);
+    }
+
+    if (telemetry_callback)
+        telemetry_callback(this);
+}
+
+robot_interface_t::packet_t robot_interface_t::servo_list_packet(unsigned char command) {
+    auto &servos = chain->servos;
+    const int servo_count = std::min<int>(servos.size(), 31);
+    int ids[31];
+
+    for (int i = 0; i < servo_count; i++)
+        ids[i] = servos[servo_count - 1 - i]->servo_num;
+
+    packet_t packet;
+    robot_protocol::encode_servo_list(command, ids, servo_count, packet);
+
+    return packet;
+}
+
+std::string robot_interface_t::get_hid_error() {
+    std::wstring err = hid_error(0);
+    return std::string(err.begin(), err.end());
+}
+
+void robot_interface_t::read_all(bool set_pos) {
+    if (!handle)
+        return;
+
+    auto packet = servo_list_packet(robot_protocol::READ_POSITIONS);
+    packet.type = packet_t::READ;
+    packet.set_pos = set_pos;
+
+    send(packet);
+}
+
+void robot_interface_t::set_servo(int id, int position, int millis) {
+    if (!handle)
+        return;
+        
+    set_servos({{id,position}}, millis);
+}
+
+void robot_interface_t::set_servos(const std::vector<std::pair<int,int>> &poses, const int time) {
+    set_servos(poses.data(), poses.size(), time);
+}
+
+void robot_interface_t::set_servos(const std::pair<int,int> *poses, int count, const int time) {
+    if (!handle)
+        return;
+
+    packet_t packet;
+    robot_protocol::encode_move(poses, count, time, packet);
+
+    send(packet);
+}
+
+void robot_interface_t::servos_off() {
+    if (!handle)
+        return;
+
+    auto packet = servo_list_packet(robot_protocol::SERVOS_OFF);
+    packet.delay_ms = 100; //why doesn't the command work every time, im trying to fix it
+    send(packet);
+}
+
+void robot_interface_t::init() {
+    hid_init();
+    handle = nullptr;
+}
+
+void robot_interface_t::set_robot_defaults() {
+    if (!handle && virtual_output)
+        serial_number = "Virtual Robot";
+}
+
+int robot_interface_t::open(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number_w) {
+    if (handle)
+        close();
+    handle = hid_open(vendor_id, product_id, serial_number_w);
+
+    if (!handle) {
+        if (virtual_output) {
+            fprintf(stderr, "No handle, create virtual output\n");
+            set_robot_defaults();
+            return glsuccess;
+        }
+        std::wstring err = hid_error(0);
+        std::string rr(err.begin(), err.end());
+        fprintf(stderr, "Not connected to robot, (nonfatal) reason: %s\n", rr.c_str());
+        serial_number = "No USB";
+        return glfail;
+    }
+
+    std::wstring wstr;
+    if (!serial_number_w) {
+        wchar_t wbuf[100];
+        if (!hid_get_serial_number_string(handle, &wbuf[0], 100))
+            wstr = std::wstring(&wbuf[0]);
+        else 
+            wstr = L"No serial";
+    } else {
+        wstr = std::wstring(serial_number_w);
+    }
+    serial_number = std::string(wstr.begin(), wstr.end());
+
+    hid_set_nonblocking(handle, 0);
+    fprintf(stderr, "Open robot connection %s\n", serial_number.c_str());
+
+    set_robot_defaults();
+    // Read inline so the segments start from the real pose
+    read_all(true);
+    start();
+
+    return glsuccess;
+}
+
+void robot_interface_t::close() {
+    if (!handle)
+        return;
+    stop();
+    hid_close(handle);
+    handle = nullptr;
+}
+
+void robot_interface_t::reset(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number_w) {
+    open(vendor_id, product_id, serial_number_w);
+}
+
+void robot_interface_t::debug_info(char *buffer, const size_t &size, size_t &offset) {
+    util::format_to(buffer, size, offset, "USB: {}\n", serial_number);
+    for (auto *seg : chain->servos) {
+        util::format_to(buffer, size, offset, "  {}: {}\n", seg->servo_num, seg->servo_cur_position);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+#include "robot_protocol.h"
+
+void robot_protocol::encode_move(const std::pair<int,int> *poses, int count, int time, robot_packet_t &packet) {
+    const int size = count * 3 + 7;
+    assert(count > 0 && "No poses");
+    assert(count <= max_servos && "Should not be that big\n");
+
+    packet = {robot_packet_t::WRITE, false, (uint8_t)size, 0};
+    unsigned char *cmd = &packet.bytes[0];
+    unsigned char header[7] = {0x55, 0x55, (unsigned char)(size - 2), MOVE, (unsigned char)count,
+        (unsigned char)(time & 0xFF), (unsigned char)(time >> 8)
+    };
+    memcpy(&cmd[0], &header[0], 7);
+
+    for (int i = 0; i < count; i++) {
+        int offset = i * 3 + 7;
+        cmd[offset] = poses[i].first;
+        cmd[offset+1] = poses[i].second & 0xFF;
+        cmd[offset+2] = poses[i].second >> 8;
+    }
+}
+
+void robot_protocol::encode_servo_list(unsigned char command, const int *ids, int count, robot_packet_t &packet) {
+    assert(count + 5 <= (int)sizeof packet.bytes && "Should not be that big\n");
+
+    packet = {robot_packet_t::WRITE, false, (uint8_t)(5 + count), 0, {
+        0x55, 0x55, (unsigned char)(count + 3), command, (unsigned char)count
+    }};
+
+    for (int i = 0; i < count; i++)
+        packet.bytes[5 + i] = ids[i];
+}
+
+bool robot_protocol::decode_positions(const unsigned char *bytes, int size, robot_telemetry_t &telemetry) {
+    if (size < 6)
+        return false;
+
+    telemetry.count = std::min<int>({bytes[4], (size - 5) / 3, (int)sizeof telemetry.ids});
+
+    for (int i = 0; i < telemetry.count; i++) {
+        int index = 5 + 3 * i;
+        telemetry.ids[i] = bytes[index];
+        telemetry.positions[i] = (bytes[index + 2] << 8) | bytes[index + 1];
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "shader.h"
 
 bool shader_t::load(const std::string &path) {
+    this->path = path;
     std::stringstream buffer;
     std::ifstream file(path);
     if (!file.is_open()) {
@@ -11,20 +12,26 @@ bool shader_t::load(const std::string &path) {
     std::string shaderCodeStr = buffer.str();
     const char* shaderCode = shaderCodeStr.c_str();
     int length = shaderCodeStr.size();
-    shaderId = glCreateShader(type);
-    glShaderSource(shaderId, 1, &shaderCode, 0);
-    glCompileShader(shaderId);
+    GLuint id = glCreateShader(type);
+    glShaderSource(id, 1, &shaderCode, 0);
+    glCompileShader(id);
     GLint compiled = 0;
-    glGetShaderiv(shaderId, GL_COMPILE_STATUS, &compiled);
+    glGetShaderiv(id, GL_COMPILE_STATUS, &compiled);
     GLint infoLen = 512;
     if (compiled == GL_FALSE) {
         char infoLog[infoLen];
-        glGetShaderInfoLog(shaderId, infoLen, nullptr, infoLog);
+        glGetShaderInfoLog(id, infoLen, nullptr, infoLog);
         std::cerr << "Error: Compiling shader: " << path << std::endl;
         std::cerr << infoLog << std::endl;
-        glDeleteShader(shaderId);
+        glDeleteShader(id);
         return glfail;
     }
 
+    // Attached programs hold on to the old shader until they are relinked
+    if (isLoaded())
+        glDeleteShader(shaderId);
+
+    shaderId = id;
+
     return glsuccess;
 }
\ No newline at end of file
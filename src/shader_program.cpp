@@ -6,21 +6,29 @@ bool shader_program_t::load() {
         assert(shader->shaderId != gluninitialized && "ShaderId not valid\n");
     }
 
-    programId = glCreateProgram();
+    GLuint id = glCreateProgram();
     
     for (auto *shader : shaders)
-        glAttachShader(programId, shader->shaderId);
+        glAttachShader(id, shader->shaderId);
 
-    glLinkProgram(programId);
+    glLinkProgram(id);
 
     int success = 0;
-    glGetProgramiv(programId, GL_LINK_STATUS, &success);
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
     if (success == GL_FALSE) {
         char infoLog[513];
-        glGetProgramInfoLog(programId, 512, NULL, infoLog);
+        glGetProgramInfoLog(id, 512, NULL, infoLog);
         std::cout << "Error: Linking shader\n" << infoLog << std::endl;
+        glDeleteProgram(id);
         return glfail;
     }
 
+    // Relink, locations may move in the new program
+    if (programId != gluninitialized)
+        glDeleteProgram(programId);
+
+    programId = id;
+    resolved_locations.clear();
+
     return glsuccess && get_uniform_locations();
 }
\ No newline at end of file
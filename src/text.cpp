@@ -119,4 +119,89 @@ void add_rect(text_t *buffer, unsigned int &vertexCount, glm::vec4 XYWH, glm::ve
 
         vertexCount++;
     }
+}
+
+text_buffer_t::text_buffer_t():
+        vao(0),
+        vbo(0),
+        vertexCount(0),
+        capacity(0) {
+
+}
+
+text_buffer_t::~text_buffer_t() {
+    if (vbo)
+        glDeleteBuffers(1, &vbo);
+    if (vao)
+        glDeleteVertexArrays(1, &vao);
+}
+
+text_t *text_buffer_t::begin(const size_t &count) {
+    if (verticies.size() < count)
+        verticies.resize(std::max(count, verticies.size() * 2));
+
+    vertexCount = 0;
+
+    return verticies.data();
+}
+
+void text_buffer_t::append(const text_t *src, const size_t &count) {
+    const size_t required = vertexCount + count;
+
+    if (verticies.size() < required)
+        verticies.resize(std::max(required, verticies.size() * 2));
+
+    memcpy(&verticies[vertexCount], src, count * sizeof(text_t));
+    vertexCount = required;
+}
+
+void text_buffer_t::upload() {
+    const size_t stride = sizeof(text_t);
+
+    if (!vao) {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        text_t().set_attrib_pointers();
+        glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    if (vertexCount > capacity) {
+        capacity = std::max(vertexCount, capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity * stride, nullptr, GL_DYNAMIC_DRAW);
+        uploaded.clear();
+    }
+
+    size_t first = 0, last = vertexCount;
+    size_t common = std::min<size_t>(vertexCount, uploaded.size());
+
+    while (first < common && !memcmp(&verticies[first], &uploaded[first], stride))
+        first++;
+
+    // Trailing verticies can only match when the buffer did not grow
+    if (vertexCount <= uploaded.size())
+        while (last > first && !memcmp(&verticies[last - 1], &uploaded[last - 1], stride))
+            last--;
+
+    uploaded.resize(vertexCount);
+
+    if (last > first) {
+        glBufferSubData(GL_ARRAY_BUFFER, first * stride, (last - first) * stride, &verticies[first]);
+        std::copy(verticies.begin() + first, verticies.begin() + last, uploaded.begin() + first);
+    }
+
+    if (debug_ui)
+        printf("Text buffer: %i verticies, uploaded [%li,%li), capacity: %i\n", vertexCount, first, last, capacity);
+}
+
+void text_buffer_t::render() {
+    if (vertexCount < 1 || !vao)
+        return;
+
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    glBindVertexArray(0);
 }
\ No newline at end of file
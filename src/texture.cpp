@@ -45,8 +45,9 @@ bool texture_t::load(const std::string &path) {
         return glfail;
     }
 
-    glGenTextures(1, &textureId);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    GLuint id;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
     glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -57,5 +58,11 @@ bool texture_t::load(const std::string &path) {
 
     stbi_image_free(image);
 
+    // Only replace the previous texture once the new one is complete
+    if (isLoaded())
+        glDeleteTextures(1, &textureId);
+
+    textureId = id;
+
     return glsuccess;
 }
\ No newline at end of file
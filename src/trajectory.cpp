@@ -0,0 +1,189 @@
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "trajectory.h"
+#include "profiler.h"
+
+trajectory_t::trajectory_t():
+        count(0),
+        duration(0.0f) {
+
+}
+
+trajectory_t::trajectory_t(const robot_chain_t &chain):
+        trajectory_t() {
+    const auto &st = chain.state;
+    count = st.count;
+
+    for (int i = 0; i < count; i++) {
+        start[i] = chain.segments[i].get_servo_interpolated<float>();
+        end[i] = st.servo_end_position[i];
+        rate[i] = st.degrees_per_second[i];
+        steps_per_degree[i] = st.steps_per_degree[i];
+        home[i] = st.servo_home[i];
+
+        duration = std::max(duration, arrival(i));
+    }
+}
+
+void trajectory_t::degrees_at(const float &time, float *degrees) const {
+    for (int i = 0; i < count; i++) {
+        const float d = end[i] - start[i];
+        const float moved = std::min(time * rate[i], std::abs(d));
+        const float steps = start[i] + (d > 0.0f ? moved : -moved);
+
+        degrees[i] = (steps - home[i]) * steps_per_degree[i];
+    }
+}
+
+trajectory_validator_t::trajectory_validator_t(int threads):
+        tolerance(0.5f),
+        max_samples(1024),
+        min_samples_per_thread(8),
+        pool(threads > 0 ? threads : std::max<int>(std::thread::hardware_concurrency(), 1)) {
+
+}
+
+void trajectory_validator_t::get_reach(const robot_chain_t &chain, float *reach) {
+    const auto &segments = chain.segments;
+    float radius[chain_state_t::capacity] = {0};
+
+    // Mesh extent around each visible segment's origin
+    for (int i = 0; i < chain.visible.size(); i++) {
+        const auto *segment = chain.visible[i];
+        const auto *bvh = chain.bvhs[i];
+
+        if (bvh->empty())
+            continue;
+
+        const auto &box = bvh->nodes[0].box;
+        const glm::vec3 far = glm::max(glm::abs(box.min), glm::abs(box.max));
+        radius[segment->joint] = glm::length(far) * segment->model_scale;
+    }
+
+    // Every segment's own extent is carried by each of its ancestors
+    for (int i = 0; i < segments.size(); i++)
+        reach[i] = 0.0f;
+
+    for (int k = 0; k < segments.size(); k++) {
+        const auto &carried = segments[k];
+        const float extent = std::max(radius[k], carried.get_length());
+        float path = 0.0f;
+
+        for (const auto *s = &carried; s; s = s->parent) {
+            reach[s->joint] = std::max(reach[s->joint], path + extent);
+
+            if (s->parent)
+                path += s->parent->get_length() + glm::length(s->offset) * s->model_scale;
+        }
+    }
+}
+
+void trajectory_validator_t::sample(const robot_chain_t &chain, const trajectory_t &move, std::vector<float> &times) const {
+    times.clear();
+
+    if (move.duration <= 0.0f) {
+        times.push_back(0.0f);
+        return;
+    }
+
+    float reach[chain_state_t::capacity];
+    get_reach(chain, reach);
+
+    // Speeds only change when a servo arrives
+    std::vector<float> breaks;
+
+    for (int i = 0; i < move.count; i++)
+        if (move.arrival(i) > 0.0f)
+            breaks.push_back(move.arrival(i));
+
+    std::sort(breaks.begin(), breaks.end());
+
+    // Even spacing when the bound asks for more samples than allowed
+    const float min_step = move.duration / max_samples;
+    float t = 0.0f;
+
+    for (float next_break : breaks) {
+        if (next_break <= t)
+            continue;
+
+        // Fastest any point moves while the servos still moving keep moving
+        float speed = 0.0f;
+
+        for (int i = 0; i < move.count; i++) {
+            if (!chain.segments[i].parent || move.arrival(i) <= t)
+                continue;
+
+            const float radians_per_second = glm::radians(move.rate[i] * std::abs(move.steps_per_degree[i]));
+            speed += radians_per_second * reach[i];
+        }
+
+        const float step = std::max(speed > 0.0f ? tolerance / speed : next_break - t, min_step);
+
+        while (t + step < next_break) {
+            t += step;
+            times.push_back(t);
+        }
+
+        t = next_break;
+        times.push_back(t);
+    }
+}
+
+float trajectory_validator_t::validate(const robot_chain_t &chain, const trajectory_t &move, collision_contact_t *contact) {
+    PROFILE_SCOPE("trajectory_validator_t::validate");
+
+    std::vector<float> times;
+    sample(chain, move, times);
+
+    const int count = times.size();
+    std::atomic<int> next(0);
+    std::atomic<int> earliest(count);
+
+    struct found_t {
+        int index;
+        collision_contact_t contact;
+    };
+
+    const int workers = std::clamp(count / std::max(min_samples_per_thread, 1), 1, pool.size());
+    std::vector<found_t> found(workers, {count, {}});
+
+    auto work = [&](int worker) {
+        float degrees[chain_state_t::capacity];
+        glm::mat4 transforms[chain_state_t::capacity];
+        collision_contact_t hit;
+
+        for (int i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            // Handed out in order, nothing after a known collision can come first
+            if (i >= earliest.load(std::memory_order_relaxed))
+                break;
+
+            move.degrees_at(times[i], degrees);
+            chain.pose(degrees, transforms);
+
+            if (!chain.check_collision(transforms, &hit))
+                continue;
+
+            found[worker] = {i, hit};
+
+            int current = earliest.load(std::memory_order_relaxed);
+            while (i < current && !earliest.compare_exchange_weak(current, i, std::memory_order_relaxed));
+            break;
+        }
+    };
+
+    pool.run(workers, work);
+
+    const int first = earliest.load();
+
+    if (first >= count)
+        return -1.0f;
+
+    if (contact)
+        for (auto &f : found)
+            if (f.index == first)
+                *contact = f.contact;
+
+    return times[first];
+}
\ No newline at end of file
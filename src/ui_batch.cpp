@@ -0,0 +1,72 @@
+#include "ui_batch.h"
+
+ui_batch_t::~ui_batch_t() {
+    for (auto *batch : batches)
+        delete batch;
+}
+
+void ui_batch_t::begin() {
+    for (auto *batch : batches)
+        batch->buffer.vertexCount = 0;
+}
+
+ui_batch_t::batch_t *ui_batch_t::get_batch(const ui_layer_t &layer, shader_program_t *shader, texture_t *texture) {
+    for (auto *batch : batches)
+        if (batch->layer == layer && batch->shader == shader && batch->texture == texture)
+            return batch;
+
+    auto *batch = new batch_t { layer, shader, texture };
+    batches.push_back(batch);
+
+    std::stable_sort(batches.begin(), batches.end(), [](const batch_t *a, const batch_t *b) {
+        if (a->layer != b->layer)
+            return a->layer < b->layer;
+        if (a->shader != b->shader)
+            return a->shader < b->shader;
+        return a->texture < b->texture;
+    });
+
+    return batch;
+}
+
+void ui_batch_t::add(const ui_layer_t &layer, shader_program_t *shader, texture_t *texture, const text_buffer_t &quads) {
+    if (quads.vertexCount < 1)
+        return;
+
+    assert(shader && "Shader null\n");
+    assert(texture && "Texture null\n");
+
+    get_batch(layer, shader, texture)->buffer.append(quads.verticies.data(), quads.vertexCount);
+}
+
+void ui_batch_t::submit() {
+    for (auto *batch : batches) {
+        auto &buffer = batch->buffer;
+
+        if (buffer.vertexCount < 1)
+            continue;
+
+        buffer.upload();
+
+        batch->shader->use();
+        batch->shader->set_sampler("textureSampler", batch->texture);
+
+        if (batch->layer == UI_LAYER_COLOR)
+            batch->shader->set_f("mixFactor", 1.0);
+
+        buffer.render();
+    }
+
+    if (debug_ui)
+        printf("UI batch: %i draws\n", get_draw_count());
+}
+
+GLuint ui_batch_t::get_draw_count() const {
+    GLuint count = 0;
+
+    for (auto *batch : batches)
+        if (batch->buffer.vertexCount > 0)
+            count++;
+
+    return count;
+}
\ No newline at end of file
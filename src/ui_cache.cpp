@@ -0,0 +1,107 @@
+#include "ui_cache.h"
+
+ui_cache_t::ui_cache_t(shader_program_t *shader):
+        fbo(0),
+        shader(shader),
+        size(0),
+        dirty(true),
+        rebuilds(0) {
+    glGenFramebuffers(1, &fbo);
+
+    // Covers the screen, v flipped to read the framebuffer texture upright
+    add_rect(quad.begin(6), quad.vertexCount, {-1.0f,-1.0f,2.0f,2.0f}, {0.0f,1.0f,1.0f,-1.0f});
+}
+
+ui_cache_t::~ui_cache_t() {
+    if (texture.isLoaded())
+        glDeleteTextures(1, &texture.textureId);
+    glDeleteFramebuffers(1, &fbo);
+}
+
+bool ui_cache_t::resize(int width, int height) {
+    if (width < 1 || height < 1)
+        return glfail;
+
+    if (size == glm::ivec2(width, height) && texture.isLoaded())
+        return glsuccess;
+
+    if (!texture.isLoaded())
+        glGenTextures(1, &texture.textureId);
+
+    texture.use(0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.textureId, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "UI framebuffer incomplete <%i,%i> status: %x\n", width, height, status);
+        return glfail;
+    }
+
+    size = {width, height};
+    dirty = true;
+
+    return glsuccess;
+}
+
+bool ui_cache_t::rebuild(ui_element_t *root, ui_batch_t *batch) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, size.x, size.y);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Store premultiplied color so compositing matches drawing directly
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    batch->begin();
+    bool ret = root->render(batch);
+    batch->submit();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer);
+    glViewport(0, 0, size.x, size.y);
+
+    dirty = false;
+    rebuilds++;
+
+    if (debug_ui)
+        printf("UI cache rebuild %i <%i,%i>\n", rebuilds, size.x, size.y);
+
+    return ret;
+}
+
+bool ui_cache_t::render(ui_element_t *root, ui_batch_t *batch) {
+    assert(shader && "Shader null\n");
+
+    if (!texture.isLoaded() && resize(current_window[2], current_window[3]))
+        return glfail;
+
+    root->update();
+
+    bool ret = glsuccess;
+
+    if (dirty || root->is_dirty())
+        ret = rebuild(root, batch);
+
+    quad.upload();
+
+    shader->use();
+    shader->set_m4("projection", glm::mat4(1.));
+    shader->set_f("mixFactor", 0.0);
+    shader->set_sampler("textureSampler", &texture);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    quad.render();
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    return ret;
+}
\ No newline at end of file
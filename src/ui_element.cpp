@@ -1,4 +1,6 @@
 #include "ui_element.h"
+#include "ui_batch.h"
+#include "profiler.h"
 
 bool ui_element_t::redraw() {
     modified = true;
@@ -6,21 +8,52 @@ bool ui_element_t::redraw() {
     return run_children(&ui_element_t::redraw);
 }
 
-bool ui_element_t::render() {
+bool ui_element_t::update() {
     if (hidden)
         return glsuccess;
 
     if (pre_render_callback)
         pre_render_callback();
 
-    auto ret = run_children(&ui_element_t::render);
+    return run_children(&ui_element_t::update);
+}
+
+bool ui_element_t::is_dirty() {
+    if (hidden != drawn_hidden)
+        return true;
+
+    if (hidden)
+        return false;
+
+    if (modified)
+        return true;
+
+    for (auto *element : children)
+        if (element->is_dirty())
+            return true;
+
+    return false;
+}
+
+bool ui_element_t::render(ui_batch_t *batch) {
+    PROFILE_SCOPE("ui_element_t::render");
+
+    drawn_hidden = hidden;
+
+    if (hidden)
+        return glsuccess;
+
+    if (modified)
+        mesh();
+
+    auto ret = run_children(&ui_element_t::render, batch);
 
     return ret;
 }
 
 bool ui_element_t::mesh() {
     modified = false;
-    vertexCount = 0;
+    buffer.vertexCount = 0;
 
     return glsuccess;
 }
@@ -87,15 +120,13 @@ bool ui_element_t::load() {
         return glfail;
     }
 
-    glGenBuffers(1, &vbo);
-    glGenVertexArrays(1, &vao);
-    vertexCount = 0;
+    buffer.vertexCount = 0;
     modified = true;
     loaded = true;
 
     if (debug_pedantic)
-        printf("Loaded <%s,%i,%i,%i,%i,<%f,%f,%f,%f>>\n",
-            get_element_name().c_str(), vbo, vao, vertexCount,
+        printf("Loaded <%s,%i,%i,<%f,%f,%f,%f>>\n",
+            get_element_name().c_str(), buffer.vertexCount,
             modified, XYWH[0], XYWH[1], XYWH[2], XYWH[3]);
 
     return glsuccess;
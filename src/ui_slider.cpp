@@ -1,5 +1,6 @@
 #include "util.h"
 #include "ui_slider.h"
+#include "ui_batch.h"
 
 ui_slider_t::ui_slider_t(GLFWwindow *window, shader_program_t *textProgram, texture_t *textTexture, glm::vec4 XYWH, ui_slider_v min, ui_slider_v max, ui_slider_v value, std::string title, bool limit, callback_t value_change_callback, bool skip_text, bool hidden):
         ui_element_t(window, XYWH),
@@ -135,7 +136,7 @@ bool ui_slider_t::onCursor(double x, double y) {
         return glsuccess;
 
     if (cursor_drag) {
-        bool shift = (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
+        bool shift = key_down(GLFW_KEY_LEFT_SHIFT);
         float fact = shift ? precise_factor : 1.;
 
         auto current_cursor = get_cursor_relative();
@@ -212,9 +213,8 @@ bool ui_slider_t::onMouse(int button, int action, int mods) {
 
 bool ui_slider_t::mesh() {
     modified = false;
-    vertexCount = 0;
 
-    text_t *buffer = new text_t[1 * 18];
+    text_t *verticies = buffer.begin(1 * 18);
 
     auto mp = get_midpoint_relative();
     auto pos = get_position();
@@ -228,40 +228,32 @@ bool ui_slider_t::mesh() {
     glm::vec4 slider_bar_color(0,0,.5,1); //50% blue
 
     //background
-    //add_rect(buffer, vertexCount, XYWH, slider_range_color, true);
+    //add_rect(verticies, buffer.vertexCount, XYWH, slider_range_color, true);
     //slider range
-    add_rect(buffer, vertexCount, slider_range_position, slider_range_color, true);
+    add_rect(verticies, buffer.vertexCount, slider_range_position, slider_range_color, true);
     //slider
-    add_rect(buffer, vertexCount, slider_bar_position, slider_bar_color, true);
-
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof * buffer, buffer, GL_STATIC_DRAW);
-
-    buffer->set_attrib_pointers();
-
-    delete [] buffer;
+    add_rect(verticies, buffer.vertexCount, slider_bar_position, slider_bar_color, true);
 
     return glsuccess;
 }
 
-bool ui_slider_t::render() {
+bool ui_slider_t::render(ui_batch_t *batch) {
+    drawn_hidden = hidden;
+
+    if (hidden)
+        return glsuccess;
+
     if (modified)
         mesh();
 
-    if (vertexCount < 1 || hidden)
+    if (buffer.vertexCount < 1)
         return glsuccess;
 
     assert(textProgram && "textProgram null\n");
 
-    textProgram->use();
-    textProgram->set_f("mixFactor", 1.0);
-
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-    glBindVertexArray(0);
+    batch->add(UI_LAYER_COLOR, textProgram, textTexture, buffer);
 
-    ui_element_t::render();
+    ui_element_t::render(batch);
     
     return glsuccess;
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "ui_text.h"
+#include "ui_batch.h"
+#include "profiler.h"
 
 ui_text_t::ui_text_t(ui_element_t ui):
         ui_element_t(ui) {
@@ -22,13 +24,12 @@ void ui_text_t::string_change() {
 }
 
 void ui_text_t::set_string(const std::string &str) {
-    string_buffer = str;
-    string_change();
+    set_string(str.c_str());
 }
 
 void ui_text_t::set_string(const char* str) {
-    std::string s = str;
-    set_string(s);
+    // assign reuses the existing capacity
+    string_buffer.assign(str);
     string_change();
 }
 
@@ -60,36 +61,27 @@ bool ui_text_t::parameters_changed() {
     return false;
 }
 
-bool ui_text_t::render() {
+bool ui_text_t::render(ui_batch_t *batch) {
     if (parameters_changed()) {
         if (debug_pedantic)
             puts("Parameters changed");
         modified = true;
     }
 
+    drawn_hidden = hidden;
+
     if (hidden)
         return glsuccess;
 
     if (modified)
         mesh();
 
-    assert(shader && "Shader null\n");
-    assert(texture && "Texture null\n");
-
-    shader->use();
-    shader->set_sampler("textureSampler", texture);
-
-    if (pre_render_callback)
-        pre_render_callback();
-
     //if (debug_pedantic)
-    //    printf("%s %i verticies\n", get_element_name().c_str(), vertexCount);
+    //    printf("%s %i verticies\n", get_element_name().c_str(), buffer.vertexCount);
 
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-    glBindVertexArray(0);
+    batch->add(UI_LAYER_TEXT, shader, texture, buffer);
 
-    return run_children(&ui_element_t::render);
+    return run_children(&ui_element_t::render, batch);
 }
 
 std::string ui_text_t::get_element_name() {
@@ -102,12 +94,15 @@ std::string ui_text_t::get_element_name() {
 }
 
 bool ui_text_t::mesh() {
-    currentX = currentY = vertexCount = 0;
+    PROFILE_SCOPE("ui_text_t::mesh");
+
+    currentX = currentY = 0;
 
     //puts(string_buffer.c_str());
     last_used = get_parameters();
 
     if (string_buffer.size() < 1) {
+        buffer.vertexCount = 0;
         modified = false;
         return glsuccess;
     }
@@ -115,7 +110,7 @@ bool ui_text_t::mesh() {
     if (!modified)
         return glsuccess;
 
-    text_t *buffer = new text_t[string_buffer.size() * 6];
+    text_t *verticies = buffer.begin(string_buffer.size() * 6);
 
     for (auto ch : string_buffer) {
         if (ch == '\n') {
@@ -127,24 +122,12 @@ bool ui_text_t::mesh() {
         glm::vec4 scr, tex;
         
         get_parameters()->calculate(ch, currentX, currentY, XYWH, scr, tex);
-        add_rect(buffer, vertexCount, scr, tex);
+        add_rect(verticies, buffer.vertexCount, scr, tex);
 
         currentX++;
     }
 
     modified = false;
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof * buffer, buffer, GL_STATIC_DRAW);
-
-    buffer->set_attrib_pointers();
-
-    if (debug_ui)
-        printf("Text buffer: %i verticies\n", vertexCount);
-
-    delete [] buffer;
-
     return glsuccess;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ui_toggle.h"
+#include "ui_batch.h"
 
 ui_toggle_t::ui_toggle_t(GLFWwindow *window, shader_program_t *textProgram, texture_t *textTexture, glm::vec4 XYWH, std::string title, bool initial_state, toggle_callback_t toggle_callback):
         ui_element_t(window, XYWH),
@@ -59,9 +60,8 @@ bool ui_toggle_t::reset() {
 
 bool ui_toggle_t::mesh() {
     modified = false;
-    vertexCount = 0;
 
-    text_t *buffer = new text_t[2 * 6];
+    text_t *verticies = buffer.begin(2 * 6);
 
     glm::vec4 button_held_color(0,0,0.5,1.);
     glm::vec4 button_on_color(0,0,1.0,1.);
@@ -69,35 +69,28 @@ bool ui_toggle_t::mesh() {
 
     glm::vec4 color = (held ? button_held_color : (toggle_state ? button_on_color : button_off_color));
 
-    add_rect(buffer, vertexCount, XYWH, color, true);
-
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof * buffer, buffer, GL_STATIC_DRAW);
-
-    buffer->set_attrib_pointers();
-
-    delete [] buffer;
+    add_rect(verticies, buffer.vertexCount, XYWH, color, true);
 
     return glsuccess;
 }
 
-bool ui_toggle_t::render() {
+bool ui_toggle_t::render(ui_batch_t *batch) {
+    drawn_hidden = hidden;
+
+    if (hidden)
+        return glsuccess;
+
     if (modified)
         mesh();
 
-    if (vertexCount < 1)
+    if (buffer.vertexCount < 1)
         return glsuccess;
 
     assert(textProgram && "textProgram null\n");
 
-    textProgram->use();
-    textProgram->set_f("mixFactor", 1.0);
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-    glBindVertexArray(0);
+    batch->add(UI_LAYER_COLOR, textProgram, textTexture, buffer);
 
-    ui_element_t::render();
+    ui_element_t::render(batch);
 
     return glsuccess;
 }
\ No newline at end of file
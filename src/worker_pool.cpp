@@ -0,0 +1,53 @@
+#include "worker_pool.h"
+
+worker_pool_t::worker_pool_t(int size):
+        running(true),
+        generation(0),
+        pending(0),
+        active(0),
+        job(nullptr),
+        context(nullptr) {
+    for (int w = 1; w < size; w++)
+        threads.emplace_back(&worker_pool_t::loop, this, w);
+}
+
+worker_pool_t::~worker_pool_t() {
+    running.store(false, std::memory_order_release);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    for (auto &thread : threads)
+        thread.join();
+}
+
+void worker_pool_t::dispatch(int count) {
+    active = count;
+    pending.store(threads.size(), std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+}
+
+void worker_pool_t::wait() {
+    int left;
+
+    while ((left = pending.load(std::memory_order_acquire)) > 0)
+        pending.wait(left, std::memory_order_acquire);
+}
+
+void worker_pool_t::loop(int worker) {
+    uint32_t seen = 0;
+
+    while (true) {
+        generation.wait(seen, std::memory_order_acquire);
+        seen = generation.load(std::memory_order_acquire);
+
+        if (!running.load(std::memory_order_acquire))
+            return;
+
+        if (worker < active)
+            job(context, worker);
+
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            pending.notify_one();
+    }
+}
\ No newline at end of file
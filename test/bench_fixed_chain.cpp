@@ -0,0 +1,169 @@
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "segment.h"
+#include "fixed_chain.h"
+
+/*
+Forward kinematics and Jacobian of the xArm IK chain, generic against
+fixed. The generic path walks segment_T parents with glm::rotate, its
+Jacobian is central differences as it has no analytic one. The fixed
+path is xarm_chain_t. Both see the same random servo positions, the
+largest disagreement is printed so a mismatch shows up next to the times.
+*/
+
+struct bench_mesh_t {
+    glm::vec3 position;
+};
+
+using bench_segment_t = segment_T<bench_mesh_t>;
+
+using clk = std::chrono::steady_clock;
+
+static volatile float sink;
+
+struct generic_chain_t {
+    chain_state_t state;
+    std::vector<bench_segment_t> segments;
+    std::vector<bench_segment_t*> ik;
+    bench_mesh_t mesh;
+
+    generic_chain_t() {
+        mesh.position = glm::vec3(0.0f);
+        segments.reserve(xarm_chain_t::joint_count);
+
+        for (int i = 0; i < xarm_chain_t::joint_count; i++) {
+            const auto &joint = xarm_topology_t::joints[i];
+            glm::vec3 axis(0.0f);
+            axis[joint.axis] = 1.0f;
+
+            int slot = state.add(robot_servo_t(i, 0, 1000, 500, 500, 500, 700.0f, 0.24f));
+            auto &segment = segments.emplace_back(i > 0 ? &segments[i - 1] : nullptr, i > 0 ? nullptr : &mesh, state, slot, axis, joint.length, glm::vec3(joint.offset[0], joint.offset[1], joint.offset[2]));
+            segment.model_scale = xarm_topology_t::model_scale;
+            ik.push_back(&segment);
+        }
+    }
+
+    void set(const int *steps) {
+        for (int i = 0; i < state.count; i++)
+            state.servo_end_position[i] = state.servo_cur_position[i] = steps[i];
+    }
+
+    glm::vec3 tip() const {
+        auto *last = ik.back();
+        return last->get_origin(false) + last->get_segment_vector(false);
+    }
+
+    void jacobian(glm::vec3 *out) {
+        // One step either side, the servo resolution
+        const float h = glm::radians(0.24f);
+
+        out[0] = glm::vec3(0.0f);
+
+        for (int i = 1; i < state.count; i++) {
+            int home = state.servo_end_position[i];
+
+            state.servo_end_position[i] = home + 1;
+            glm::vec3 plus = tip();
+            state.servo_end_position[i] = home - 1;
+            glm::vec3 minus = tip();
+            state.servo_end_position[i] = home;
+
+            out[i] = (plus - minus) / (2.0f * h);
+        }
+    }
+};
+
+template<typename F>
+double time_ns(int iterations, F &&f) {
+    auto begin = clk::now();
+
+    for (int i = 0; i < iterations; i++)
+        f(i);
+
+    return std::chrono::duration<double, std::nano>(clk::now() - begin).count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    const int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+    const int pose_count = 1024;
+    const int joints = xarm_chain_t::joint_count;
+
+    generic_chain_t generic;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> step(100, 900);
+
+    std::vector<int> steps(pose_count * joints);
+    std::vector<float> degrees(pose_count * joints);
+
+    for (int i = 0; i < pose_count * joints; i++) {
+        steps[i] = step(rng);
+        degrees[i] = generic.segments[i % joints].get_servo_degrees(steps[i]);
+    }
+
+    float fk_error = 0.0f, jacobian_error = 0.0f;
+
+    for (int p = 0; p < pose_count; p++) {
+        generic.set(&steps[p * joints]);
+
+        xarm_chain_t::pose_t pose;
+        xarm_chain_t::jacobian_t fixed_j;
+        glm::vec3 generic_j[joints];
+
+        xarm_chain_t::forward(glm::vec3(0.0f), &degrees[p * joints], pose);
+        xarm_chain_t::jacobian(pose, fixed_j);
+        generic.jacobian(generic_j);
+
+        fk_error = std::max(fk_error, glm::length(pose.tip - generic.tip()));
+
+        for (int i = 0; i < joints; i++)
+            jacobian_error = std::max(jacobian_error, glm::length(fixed_j[i] - generic_j[i]));
+    }
+
+    double generic_fk = time_ns(iterations, [&](int i) {
+        generic.set(&steps[(i % pose_count) * joints]);
+        sink = generic.tip().x;
+    });
+
+    double fixed_fk = time_ns(iterations, [&](int i) {
+        xarm_chain_t::pose_t pose;
+        xarm_chain_t::forward(glm::vec3(0.0f), &degrees[(i % pose_count) * joints], pose);
+        sink = pose.tip.x;
+    });
+
+    double fixed_segments = time_ns(iterations, [&](int i) {
+        generic.set(&steps[(i % pose_count) * joints]);
+        xarm_chain_t::pose_t pose;
+        xarm_chain_t::forward(generic.ik, false, pose);
+        sink = pose.tip.x;
+    });
+
+    double generic_jacobian = time_ns(iterations / 10, [&](int i) {
+        glm::vec3 j[joints];
+        generic.set(&steps[(i % pose_count) * joints]);
+        generic.jacobian(j);
+        sink = j[1].x;
+    });
+
+    double fixed_jacobian = time_ns(iterations, [&](int i) {
+        xarm_chain_t::pose_t pose;
+        xarm_chain_t::jacobian_t j;
+        xarm_chain_t::forward(glm::vec3(0.0f), &degrees[(i % pose_count) * joints], pose);
+        xarm_chain_t::jacobian(pose, j);
+        sink = j[1].x;
+    });
+
+    printf("%-26s %10s %10s\n", "path", "ns/call", "speedup");
+    printf("%-26s %10.1f %10s\n", "generic fk", generic_fk, "");
+    printf("%-26s %10.1f %10.1fx\n", "fixed fk", fixed_fk, generic_fk / fixed_fk);
+    printf("%-26s %10.1f %10.1fx\n", "fixed fk from segments", fixed_segments, generic_fk / fixed_segments);
+    printf("%-26s %10.1f %10s\n", "generic jacobian (diff)", generic_jacobian, "");
+    printf("%-26s %10.1f %10.1fx\n", "fixed fk + jacobian", fixed_jacobian, generic_jacobian / fixed_jacobian);
+    printf("max tip error %g, max jacobian error %g\n", fk_error, jacobian_error);
+
+    return 0;
+}
\ No newline at end of file
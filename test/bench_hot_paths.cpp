@@ -0,0 +1,397 @@
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/utsname.h>
+
+#include "robot_description.h"
+#include "robot_interface.h"
+#include "robot_protocol.h"
+#include "kinematics.h"
+#include "mesh.h"
+
+/*
+Micro-benchmarks of the per frame robot paths on the real chain from the
+robot description: model transforms, servo interpolation, the servo
+command batch, IK and the servo protocol. Meshes are loaded for the
+collision checks, no GL context is needed.
+
+The process is pinned to one CPU and every case but one measures that
+core alone, IK validation included, so results compare across machines.
+solve_inverse_collision_pool validates on the thread pool the app ships
+with, one thread per core, and depends on validate_threads in the results.
+Each case runs until the
+median of its last few samples settles, then iterations are scaled so a
+sample takes sample_ms, then samples are taken. Results are ns per
+operation, printed as a table and optionally written as JSON to compare
+runs across builds and machines.
+*/
+
+using clk = std::chrono::steady_clock;
+
+static volatile float sink;
+
+struct bench_case_t {
+    const char *name;
+    // Operations one iteration does, results are per operation
+    int ops;
+    std::function<void(long begin, long count)> run;
+};
+
+// Loop kept inside the case so the body inlines, called through std::function once per sample
+template<typename F>
+bench_case_t make_case(const char *name, int ops, F body) {
+    return {name, ops, [body](long begin, long count) mutable {
+        for (long i = begin; i < begin + count; i++)
+            body(i);
+    }};
+}
+
+struct bench_result_t {
+    const char *name;
+    long iterations;
+    int warmup_samples;
+    double min, median, mean, p99, max;
+};
+
+struct bench_runner_t {
+    int samples = 50;
+    double sample_ms = 2.0;
+    double warmup_ms = 200.0;
+    // Warmup ends once the median of the last window is within this of the one before
+    double settle = 0.02;
+    static constexpr int window = 5;
+
+    double time_sample(bench_case_t &c, long iterations, long &cursor) const {
+        auto begin = clk::now();
+        c.run(cursor, iterations);
+        cursor += iterations;
+        return std::chrono::duration<double, std::nano>(clk::now() - begin).count() / (double(iterations) * c.ops);
+    }
+
+    static double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    bench_result_t run(bench_case_t &c) const {
+        long cursor = 0;
+        long iterations = 1;
+
+        // Long enough per sample that the clock's resolution does not matter
+        while (time_sample(c, iterations, cursor) * iterations * c.ops < sample_ms * 1e6 && iterations < (1L << 40))
+            iterations *= 2;
+
+        std::vector<double> times;
+        double previous = 0.0, warmed = 0.0;
+        int warmup = 0;
+
+        for (;;) {
+            auto begin = clk::now();
+            times.clear();
+
+            for (int i = 0; i < window; i++)
+                times.push_back(time_sample(c, iterations, cursor));
+
+            warmed += std::chrono::duration<double, std::milli>(clk::now() - begin).count();
+            warmup += window;
+
+            double current = median(times);
+            bool settled = previous > 0.0 && std::abs(current - previous) <= settle * previous;
+            previous = current;
+
+            if ((settled && warmed >= warmup_ms) || warmed >= warmup_ms * 10.0)
+                break;
+        }
+
+        // Frequency scaling may have moved during warmup, calibrate again
+        iterations = std::max<long>(sample_ms * 1e6 / (previous * c.ops), 1);
+        times.clear();
+
+        for (int i = 0; i < samples; i++)
+            times.push_back(time_sample(c, iterations, cursor));
+
+        std::sort(times.begin(), times.end());
+
+        double sum = 0.0;
+        for (double t : times)
+            sum += t;
+
+        size_t rank = std::ceil(0.99 * times.size());
+
+        return {c.name, iterations, warmup, times.front(), times[times.size() / 2], sum / times.size(),
+            times[std::clamp<size_t>(rank, 1, times.size()) - 1], times.back()};
+    }
+};
+
+// Pinned so the scheduler cannot migrate a case between cores, or between big and little cores
+bool pin_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    if (sched_setaffinity(0, sizeof set, &set)) {
+        fprintf(stderr, "Failed to pin to CPU %i, %s\n", cpu, strerror(errno));
+        return glfail;
+    }
+
+    return glsuccess;
+}
+
+bool write_json(const char *path, const char *robot_path, int cpu, int threads, const bench_runner_t &runner, const std::vector<bench_result_t> &results) {
+    FILE *file = fopen(path, "w");
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", path, strerror(errno));
+        return glfail;
+    }
+
+    utsname host;
+    uname(&host);
+
+    fprintf(file, "{\n  \"arch\": \"%s\",\n  \"system\": \"%s %s\",\n  \"host\": \"%s\",\n  \"compiler\": \"%s\",\n  \"cpu\": %i,\n  \"validate_threads\": %i,\n  \"robot\": \"%s\",\n  \"samples\": %i,\n  \"sample_ms\": %f,\n  \"unit\": \"ns\",\n  \"cases\": {\n",
+        host.machine, host.sysname, host.release, host.nodename, __VERSION__, cpu, threads, robot_path, runner.samples, runner.sample_ms);
+
+    for (int i = 0; i < results.size(); i++) {
+        auto &r = results[i];
+        fprintf(file, "    \"%s\": {\"iterations\": %li, \"warmup_samples\": %i, \"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"p99\": %.3f, \"max\": %.3f}%s\n",
+            r.name, r.iterations, r.warmup_samples, r.min, r.median, r.mean, r.p99, r.max,
+            i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+
+    return glsuccess;
+}
+
+void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n\
+  --robot PATH      robot description, default assets/xarm.robot\n\
+  --json PATH       write results as JSON to PATH\n\
+  --filter TEXT     run only cases whose name contains TEXT\n\
+  --cpu N           pin the benchmark thread to CPU N, default the CPU it starts on\n\
+  --samples N       samples per case, default 50\n\
+  --sample-ms MS    time per sample, default 2\n\
+  --warmup-ms MS    least warmup per case, default 200\n", program);
+}
+
+int main(int argc, char **argv) {
+    const char *robot_path = "assets/xarm.robot";
+    const char *json_path = nullptr;
+    const char *filter = nullptr;
+    int cpu = sched_getcpu();
+    bench_runner_t runner;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--robot" && has_value) {
+            robot_path = argv[++i];
+        } else
+        if (arg == "--json" && has_value) {
+            json_path = argv[++i];
+        } else
+        if (arg == "--filter" && has_value) {
+            filter = argv[++i];
+        } else
+        if (arg == "--cpu" && has_value) {
+            cpu = atoi(argv[++i]);
+        } else
+        if (arg == "--samples" && has_value) {
+            runner.samples = std::max(atoi(argv[++i]), 1);
+        } else
+        if (arg == "--sample-ms" && has_value) {
+            runner.sample_ms = std::max(atof(argv[++i]), 0.01);
+        } else
+        if (arg == "--warmup-ms" && has_value) {
+            runner.warmup_ms = std::max(atof(argv[++i]), 0.0);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    robot_description_t description;
+    robot_chain_t chain;
+
+    if (description.load(robot_path) || chain.compile(description) || chain.load_meshes())
+        return 1;
+
+    auto &st = chain.state;
+    const int servo_count = chain.servos.size();
+    constexpr int pose_count = 256;
+    std::mt19937 rng(1);
+
+    // Random in range servo positions, one row per pose
+    std::vector<int> poses(pose_count * st.count);
+
+    for (int p = 0; p < pose_count; p++) {
+        for (int i = 0; i < st.count; i++) {
+            std::uniform_int_distribution<int> step(std::min(st.servo_min[i], st.servo_max[i]), std::max(st.servo_min[i], st.servo_max[i]));
+            poses[p * st.count + i] = step(rng);
+        }
+    }
+
+    auto set_pose = [&](int p) {
+        std::copy_n(&poses[p * st.count], st.count, st.servo_end_position);
+        std::copy_n(&poses[p * st.count], st.count, st.servo_cur_position);
+    };
+
+    // IK targets are tips of random poses, reachable by construction
+    std::vector<vec3_d> targets(pose_count);
+
+    for (int p = 0; p < pose_count; p++) {
+        set_pose(p);
+        targets[p] = chain.get_tip(false);
+    }
+
+    set_pose(0);
+    sim_clock_t::sampled = sim_clock_t::duration(0);
+
+    int start_end[chain_state_t::capacity], start_cur[chain_state_t::capacity];
+    segment_t::tp start_command[chain_state_t::capacity];
+
+    std::copy_n(st.servo_end_position, st.count, start_end);
+    std::copy_n(st.servo_cur_position, st.count, start_cur);
+    std::copy_n(st.last_command, st.count, start_command);
+
+    auto restore = [&]() {
+        std::copy_n(start_end, st.count, st.servo_end_position);
+        std::copy_n(start_cur, st.count, st.servo_cur_position);
+        std::copy_n(start_command, st.count, st.last_command);
+    };
+
+    kinematics_t kinematics(&chain, 1);
+
+    // Validation threads as the app runs them, started before pinning so they keep every CPU
+    kinematics_t shipped(&chain);
+    const int threads = shipped.validator.pool.size();
+
+    if (cpu < 0 || pin_cpu(cpu))
+        return 1;
+
+    robot_interface_t interface(&chain, true);
+
+    // Every servo mid move toward the pose after the current one, elapsed time swept
+    auto set_moving = [&](long i) {
+        const int p = i % pose_count;
+        set_pose(p);
+        std::copy_n(&poses[((p + 1) % pose_count) * st.count], st.count, st.servo_end_position);
+        std::fill_n(st.last_command, st.count, segment_t::tp());
+        sim_clock_t::sampled = std::chrono::milliseconds(i % 1024);
+    };
+
+    std::vector<bench_case_t> cases;
+
+    cases.push_back(make_case("get_model_transform", chain.segments.size(), [&](long i) {
+        set_pose(i % pose_count);
+        float sum = 0.0f;
+
+        for (auto &segment : chain.segments)
+            sum += segment.get_model_transform(true)[3][0];
+
+        sink = sum;
+    }));
+
+    cases.push_back(make_case("get_servo_interpolated", servo_count, [&](long i) {
+        sim_clock_t::sampled = std::chrono::milliseconds(i % 1024);
+        int sum = 0;
+
+        for (auto *servo : chain.servos)
+            sum += servo->get_servo_interpolated();
+
+        sink = sum;
+    }));
+
+    cases.push_back(make_case("get_servo_targets", 1, [&](long i) {
+        alignas(32) int target[chain_state_t::capacity];
+        alignas(32) int interp[chain_state_t::capacity];
+        alignas(32) int dist[chain_state_t::capacity];
+
+        interface.get_servo_targets(segment_t::tp(std::chrono::milliseconds(i % 1024)), target, interp, dist);
+        sink = target[0] + interp[st.count - 1] + dist[1];
+    }));
+
+    cases.push_back(make_case("solve_inverse", 1, [&](long i) {
+        restore();
+        sink = kinematics.solve_inverse(targets[i % pose_count]);
+    }));
+
+    cases.push_back(make_case("solve_inverse_collision", 1, [&](long i) {
+        restore();
+        sink = kinematics.solve_inverse(targets[i % pose_count]);
+    }));
+
+    cases.push_back(make_case("solve_inverse_collision_pool", 1, [&](long i) {
+        restore();
+        sink = shipped.solve_inverse(targets[i % pose_count]);
+    }));
+
+    cases.push_back(make_case("encode_move", 1, [&](long i) {
+        std::pair<int,int> commands[robot_protocol::max_servos];
+        const int *pose = &poses[(i % pose_count) * st.count];
+
+        for (int s = 0; s < servo_count; s++)
+            commands[s] = {chain.servos[s]->servo_num, pose[chain.servos[s]->joint]};
+
+        robot_packet_t packet;
+        robot_protocol::encode_move(commands, servo_count, 10 + i % 200, packet);
+        sink = packet.bytes[packet.size - 1];
+    }));
+
+    // A positions reply for every servo, as the controller sends it
+    robot_packet_t reply;
+    std::vector<int> servo_ids(servo_count);
+
+    for (int s = 0; s < servo_count; s++)
+        servo_ids[s] = chain.servos[s]->servo_num;
+
+    robot_protocol::encode_servo_list(robot_protocol::READ_POSITIONS, servo_ids.data(), servo_count, reply);
+
+    for (int s = 0; s < servo_count; s++) {
+        reply.bytes[5 + 3 * s] = servo_ids[s];
+        reply.bytes[6 + 3 * s] = poses[s] & 0xFF;
+        reply.bytes[7 + 3 * s] = poses[s] >> 8;
+    }
+
+    cases.push_back(make_case("decode_positions", 1, [&](long i) {
+        robot_telemetry_t telemetry;
+        reply.bytes[6] = i;
+        robot_protocol::decode_positions(&reply.bytes[0], 5 + 3 * servo_count, telemetry);
+        sink = telemetry.positions[0];
+    }));
+
+    std::vector<bench_result_t> results;
+
+    printf("%s on CPU %i, %i pool validation threads, ns per operation\n", robot_path, cpu, threads);
+    printf("%-30s %10s %10s %10s %10s %12s\n", "case", "min", "median", "mean", "p99", "iterations");
+
+    for (auto &c : cases) {
+        if (filter && !strstr(c.name, filter))
+            continue;
+
+        // Cases that move the servos each start from the same state
+        restore();
+        sim_clock_t::sampled = sim_clock_t::duration(0);
+
+        if (!strcmp(c.name, "get_servo_interpolated") || !strcmp(c.name, "get_servo_targets"))
+            set_moving(0);
+
+        kinematics.collision_checking = !strcmp(c.name, "solve_inverse_collision");
+
+        auto &r = results.emplace_back(runner.run(c));
+        printf("%-30s %10.1f %10.1f %10.1f %10.1f %12li\n", r.name, r.min, r.median, r.mean, r.p99, r.iterations);
+    }
+
+    if (json_path && write_json(json_path, robot_path, cpu, threads, runner, results))
+        return 1;
+
+    return 0;
+}
\ No newline at end of file
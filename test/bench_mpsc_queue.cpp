@@ -0,0 +1,129 @@
+#include <thread>
+#include <mutex>
+#include <deque>
+
+#include "gui.h"
+
+/*
+Contention benchmark for gui::events::MPSCQueue.
+N producers push timestamped events while one consumer drains, as HID
+readers and callbacks would post to the main thread. A mutex guarded
+deque runs the same workload for comparison.
+*/
+
+struct bench_event_t {
+    int64_t stamp;
+    int producer;
+};
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(gui::clk::now().time_since_epoch()).count();
+}
+
+struct mutex_queue_t {
+    std::mutex lock;
+    std::deque<bench_event_t> events;
+
+    bool push(const bench_event_t &e) {
+        std::lock_guard guard(lock);
+        events.push_back(e);
+        return true;
+    }
+
+    bool pop(bench_event_t &e) {
+        std::lock_guard guard(lock);
+
+        if (events.empty())
+            return false;
+
+        e = events.front();
+        events.pop_front();
+        return true;
+    }
+};
+
+struct result_t {
+    double seconds, p50, p99;
+    size_t retries;
+};
+
+template<typename Queue>
+result_t run(Queue &queue, int producers, size_t per_producer) {
+    std::atomic<bool> start(false);
+    std::atomic<size_t> retries(0);
+    std::vector<std::thread> threads;
+    std::vector<int64_t> latencies;
+
+    latencies.reserve(producers * per_producer / 64 + 1);
+
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            size_t local_retries = 0;
+
+            while (!start.load(std::memory_order_acquire));
+
+            for (size_t i = 0; i < per_producer; i++) {
+                while (!queue.push({now_ns(), p})) {
+                    local_retries++;
+                    std::this_thread::yield();
+                }
+            }
+
+            retries += local_retries;
+        });
+    }
+
+    const size_t total = producers * per_producer;
+    size_t received = 0;
+    bench_event_t e;
+
+    auto begin = gui::clk::now();
+    start.store(true, std::memory_order_release);
+
+    while (received < total) {
+        if (!queue.pop(e))
+            continue;
+
+        if ((received++ & 63) == 0)
+            latencies.push_back(now_ns() - e.stamp);
+    }
+
+    double seconds = gui::dur<>(gui::clk::now() - begin).count();
+
+    for (auto &thread : threads)
+        thread.join();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    return {
+        seconds,
+        latencies[latencies.size() / 2] / 1e3,
+        latencies[latencies.size() * 99 / 100] / 1e3,
+        retries.load()
+    };
+}
+
+int main(int argc, char **argv) {
+    size_t per_producer = argc > 1 ? atol(argv[1]) : 1000000;
+    int max_producers = std::max<int>(std::thread::hardware_concurrency() - 1, 1);
+
+    printf("%-8s %9s %12s %12s %12s %10s\n", "queue", "producers", "Mevents/s", "p50 us", "p99 us", "retries");
+
+    for (int producers = 1; producers <= max_producers; producers *= 2) {
+        auto *mpsc = new gui::events::MPSCQueue<bench_event_t, 4096>();
+        auto *locked = new mutex_queue_t();
+
+        auto a = run(*mpsc, producers, per_producer);
+        auto b = run(*locked, producers, per_producer);
+
+        double events = double(producers * per_producer);
+
+        printf("%-8s %9i %12.2f %12.2f %12.2f %10zu\n", "mpsc", producers, events / a.seconds / 1e6, a.p50, a.p99, a.retries);
+        printf("%-8s %9i %12.2f %12.2f %12.2f %10zu\n", "mutex", producers, events / b.seconds / 1e6, b.p50, b.p99, b.retries);
+
+        delete mpsc;
+        delete locked;
+    }
+
+    return 0;
+}
\ No newline at end of file
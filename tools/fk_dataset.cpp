@@ -0,0 +1,503 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <charconv>
+#include <errno.h>
+#include <string.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "robot_description.h"
+
+/*
+Forward kinematics dataset generator, no window, GL or meshes. Sweeps
+the servo joints between the description's effector and its root over a
+grid or at random within servo_min and servo_max, and streams one record
+per sample:
+
+    index, degrees of each swept joint, effector position, orientation
+
+The effector is the joint with the wrist role, else the last IK joint.
+Positions are world units with the root at its description offset, the
+orientation is the effector frame as a quaternion w, x, y, z.
+
+Samples are split into chunks. Each worker owns a range of chunks and
+takes from its front, an idle worker steals the back half of another's
+range. Finished chunks go through a fixed pool of buffers to the writer,
+so memory stays bounded at any sample count. Chunks are written as they
+finish, the index orders them. Random samples are seeded per chunk, the
+same seed and chunk size give the same records at any thread count.
+*/
+
+struct dataset_mesh_t {
+    glm::vec3 position;
+};
+
+using dataset_segment_t = segment_T<dataset_mesh_t>;
+
+// The description compiled like robot_chain_t::compile, without meshes. Posing writes its servo state, one per worker
+struct dataset_chain_t {
+    chain_state_t state;
+    std::vector<dataset_segment_t> segments;
+    dataset_mesh_t mesh;
+    // Servo joints from the root to the effector
+    std::vector<int> swept;
+    int effector;
+
+    bool compile(const robot_description_t &description) {
+        const auto &joints = description.joints;
+
+        if (joints.size() > chain_state_t::capacity) {
+            fprintf(stderr, "Error: %s: %i joints, at most %i are supported\n", description.path.c_str(), (int)joints.size(), chain_state_t::capacity);
+            return glfail;
+        }
+
+        segments.clear();
+        segments.reserve(joints.size());
+        state.clear();
+        mesh.position = glm::vec3(0.0f);
+        effector = -1;
+
+        int last_ik = -1;
+
+        for (int i = 0; i < joints.size(); i++) {
+            const auto &joint = joints[i];
+            dataset_segment_t *parent = joint.parent.empty() ? nullptr : &segments[description.find(joint.parent)];
+
+            int slot = state.add(joint.servo);
+            auto &segment = segments.emplace_back(parent, parent ? nullptr : &mesh, state, slot, joint.axis, joint.length, joint.offset);
+            segment.model_scale = description.model_scale;
+
+            if (joint.role == "wrist")
+                effector = i;
+
+            if (joint.ik)
+                last_ik = i;
+        }
+
+        if (effector < 0)
+            effector = last_ik >= 0 ? last_ik : joints.size() - 1;
+
+        swept.clear();
+
+        for (const auto *s = &segments[effector]; s; s = s->parent)
+            if (s->servo_num > 0)
+                swept.insert(swept.begin(), s->joint);
+
+        if (swept.empty()) {
+            fprintf(stderr, "Error: %s: no servo joints move %s\n", description.path.c_str(), joints[effector].name.c_str());
+            return glfail;
+        }
+
+        return glsuccess;
+    }
+
+    inline void evaluate(const int *steps, float *degrees, glm::vec3 &position, glm::quat &orientation) {
+        for (int j = 0; j < swept.size(); j++) {
+            auto &segment = segments[swept[j]];
+            segment.servo_end_position = steps[j];
+            degrees[j] = segment.get_servo_degrees();
+        }
+
+        const auto &end = segments[effector];
+        position = end.get_origin(false) + end.get_segment_vector(false);
+        orientation = glm::quat_cast(glm::mat3(end.get_rotation_matrix(false)));
+    }
+};
+
+struct dataset_sweep_t {
+    bool random;
+    // Points per joint on the grid, samples at random
+    int grid;
+    uint64_t count;
+    uint64_t seed;
+    std::vector<int> min, max;
+
+    inline uint64_t total(int joints) const {
+        if (random)
+            return count;
+
+        uint64_t n = 1;
+
+        for (int j = 0; j < joints; j++) {
+            if (n > UINT64_MAX / grid)
+                return 0;
+            n *= grid;
+        }
+
+        return n;
+    }
+
+    // Last joint varies fastest
+    inline void sample(uint64_t index, std::mt19937_64 &rng, int *steps) const {
+        const int joints = min.size();
+
+        if (random) {
+            for (int j = 0; j < joints; j++)
+                steps[j] = std::uniform_int_distribution<int>(min[j], max[j])(rng);
+            return;
+        }
+
+        for (int j = joints - 1; j >= 0; j--) {
+            const int digit = index % grid;
+            index /= grid;
+            steps[j] = min[j] + (int)std::lround(double(digit) * (max[j] - min[j]) / (grid - 1));
+        }
+    }
+};
+
+// Ranges of chunks per worker, owners take from the front and thieves from the back
+struct chunk_scheduler_t {
+    struct range_t {
+        std::mutex lock;
+        uint64_t begin, end;
+    };
+
+    std::vector<range_t> ranges;
+
+    chunk_scheduler_t(int workers, uint64_t chunks):ranges(workers) {
+        for (int w = 0; w < workers; w++) {
+            ranges[w].begin = chunks * w / workers;
+            ranges[w].end = chunks * (w + 1) / workers;
+        }
+    }
+
+    bool next(int worker, uint64_t &chunk) {
+        auto &own = ranges[worker];
+
+        {
+            std::lock_guard guard(own.lock);
+
+            if (own.begin < own.end) {
+                chunk = own.begin++;
+                return true;
+            }
+        }
+
+        for (int i = 1; i < ranges.size(); i++) {
+            auto &victim = ranges[(worker + i) % ranges.size()];
+            uint64_t begin, end;
+
+            {
+                std::lock_guard guard(victim.lock);
+
+                if (victim.begin >= victim.end)
+                    continue;
+
+                // Back half, or the last chunk left
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+
+            std::lock_guard guard(own.lock);
+            chunk = begin;
+            own.begin = begin + 1;
+            own.end = end;
+
+            return true;
+        }
+
+        return false;
+    }
+};
+
+// Fixed set of buffers cycling between the workers and the writer
+struct buffer_pool_t {
+    struct buffer_t {
+        std::vector<char> data;
+        uint64_t samples;
+    };
+
+    std::vector<buffer_t> buffers;
+    std::vector<buffer_t*> free;
+    std::deque<buffer_t*> full;
+    std::mutex lock;
+    std::condition_variable free_ready, full_ready;
+
+    buffer_pool_t(int count):buffers(count) {
+        for (auto &buffer : buffers)
+            free.push_back(&buffer);
+    }
+
+    buffer_t *acquire() {
+        std::unique_lock guard(lock);
+        free_ready.wait(guard, [&]{ return !free.empty(); });
+
+        auto *buffer = free.back();
+        free.pop_back();
+
+        return buffer;
+    }
+
+    void submit(buffer_t *buffer) {
+        {
+            std::lock_guard guard(lock);
+            full.push_back(buffer);
+        }
+        full_ready.notify_one();
+    }
+
+    buffer_t *take() {
+        std::unique_lock guard(lock);
+        full_ready.wait(guard, [&]{ return !full.empty(); });
+
+        auto *buffer = full.front();
+        full.pop_front();
+
+        return buffer;
+    }
+
+    void release(buffer_t *buffer) {
+        {
+            std::lock_guard guard(lock);
+            free.push_back(buffer);
+        }
+        free_ready.notify_one();
+    }
+};
+
+struct dataset_header_t {
+    static constexpr uint32_t magic_value = 0x5344584e; // "NXDS"
+    static constexpr uint32_t version_value = 1;
+
+    uint32_t magic, version;
+    // Servo ids of the swept joints follow the header, one int32 each
+    uint32_t joints, record_size;
+    uint64_t count;
+};
+
+template<typename T>
+static inline void append(std::vector<char> &out, const T &value) {
+    const char *bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof value);
+}
+
+static inline void append_text(std::vector<char> &out, float value, char separator) {
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof text, value);
+    out.insert(out.end(), text, result.ptr);
+    out.push_back(separator);
+}
+
+void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s (--grid N | --random COUNT) --out PATH [options]\n\
+  --robot PATH      robot description, default assets/xarm.robot\n\
+  --grid N          N evenly spaced positions per joint, N to the joint count samples\n\
+  --random COUNT    COUNT uniformly random samples\n\
+  --seed S          random seed, default 1\n\
+  --threads N       worker threads, default one per core\n\
+  --chunk N         samples per chunk, default 16384\n\
+  --csv             write CSV with a header line instead of binary records\n\
+  --out PATH        output file, - for stdout\n", program);
+}
+
+int main(int argc, char **argv) {
+    const char *robot_path = "assets/xarm.robot";
+    const char *out_path = nullptr;
+    int threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    uint64_t chunk_size = 16384;
+    bool csv = false;
+    dataset_sweep_t sweep = {false, 0, 0, 1};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--robot" && has_value) {
+            robot_path = argv[++i];
+        } else
+        if (arg == "--grid" && has_value) {
+            sweep.random = false;
+            sweep.grid = atoi(argv[++i]);
+        } else
+        if (arg == "--random" && has_value) {
+            sweep.random = true;
+            sweep.count = strtoull(argv[++i], nullptr, 10);
+        } else
+        if (arg == "--seed" && has_value) {
+            sweep.seed = strtoull(argv[++i], nullptr, 10);
+        } else
+        if (arg == "--threads" && has_value) {
+            threads = std::max(atoi(argv[++i]), 1);
+        } else
+        if (arg == "--chunk" && has_value) {
+            chunk_size = std::max<uint64_t>(strtoull(argv[++i], nullptr, 10), 1);
+        } else
+        if (arg == "--csv") {
+            csv = true;
+        } else
+        if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!out_path || (sweep.random ? sweep.count < 1 : sweep.grid < 2)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    robot_description_t description;
+
+    if (description.load(robot_path))
+        return 1;
+
+    // Every worker poses its own chain
+    std::vector<dataset_chain_t> chains(threads);
+
+    for (auto &chain : chains)
+        if (chain.compile(description))
+            return 1;
+
+    const auto &reference = chains.front();
+    const int joints = reference.swept.size();
+
+    for (int j : reference.swept) {
+        const auto &segment = reference.segments[j];
+        sweep.min.push_back(std::min(segment.servo_min, segment.servo_max));
+        sweep.max.push_back(std::max(segment.servo_min, segment.servo_max));
+    }
+
+    const uint64_t total = sweep.total(joints);
+
+    if (total < 1) {
+        fprintf(stderr, "Error: %i grid points over %i joints is too many samples\n", sweep.grid, joints);
+        return 1;
+    }
+
+    FILE *file = strcmp(out_path, "-") ? fopen(out_path, "wb") : stdout;
+
+    if (!file) {
+        fprintf(stderr, "Failed to open %s, %s\n", out_path, strerror(errno));
+        return 1;
+    }
+
+    const uint32_t record_size = sizeof(uint64_t) + sizeof(float) * (joints + 3 + 4);
+
+    if (csv) {
+        std::string header = "index";
+
+        for (int j : reference.swept)
+            header += "," + description.joints[j].name;
+
+        header += ",x,y,z,qw,qx,qy,qz\n";
+        fwrite(header.data(), 1, header.size(), file);
+    } else {
+        const dataset_header_t header = {dataset_header_t::magic_value, dataset_header_t::version_value, (uint32_t)joints, record_size, total};
+        fwrite(&header, sizeof header, 1, file);
+
+        for (int j : reference.swept) {
+            const int32_t servo = reference.segments[j].servo_num;
+            fwrite(&servo, sizeof servo, 1, file);
+        }
+    }
+
+    const uint64_t chunks = (total + chunk_size - 1) / chunk_size;
+    chunk_scheduler_t scheduler(threads, chunks);
+    buffer_pool_t pool(threads * 2);
+
+    auto work = [&](int worker) {
+        auto &chain = chains[worker];
+        int steps[chain_state_t::capacity];
+        float degrees[chain_state_t::capacity];
+        glm::vec3 position;
+        glm::quat orientation;
+        uint64_t chunk;
+
+        while (scheduler.next(worker, chunk)) {
+            auto *buffer = pool.acquire();
+            auto &out = buffer->data;
+
+            const uint64_t first = chunk * chunk_size;
+            const uint64_t last = std::min(first + chunk_size, total);
+            std::mt19937_64 rng(sweep.seed * 0x9e3779b97f4a7c15ull + chunk);
+
+            out.clear();
+            out.reserve((last - first) * (csv ? 16 * (joints + 8) : record_size));
+            buffer->samples = last - first;
+
+            for (uint64_t index = first; index < last; index++) {
+                sweep.sample(index, rng, steps);
+                chain.evaluate(steps, degrees, position, orientation);
+
+                if (csv) {
+                    char text[24];
+                    auto result = std::to_chars(text, text + sizeof text, index);
+                    out.insert(out.end(), text, result.ptr);
+                    out.push_back(',');
+
+                    for (int j = 0; j < joints; j++)
+                        append_text(out, degrees[j], ',');
+
+                    append_text(out, position.x, ',');
+                    append_text(out, position.y, ',');
+                    append_text(out, position.z, ',');
+                    append_text(out, orientation.w, ',');
+                    append_text(out, orientation.x, ',');
+                    append_text(out, orientation.y, ',');
+                    append_text(out, orientation.z, '\n');
+                } else {
+                    append(out, index);
+
+                    for (int j = 0; j < joints; j++)
+                        append(out, degrees[j]);
+
+                    append(out, position);
+                    append(out, orientation.w);
+                    append(out, orientation.x);
+                    append(out, orientation.y);
+                    append(out, orientation.z);
+                }
+            }
+
+            pool.submit(buffer);
+        }
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+
+    for (int w = 0; w < threads; w++)
+        workers.emplace_back(work, w);
+
+    uint64_t written = 0, bytes = 0;
+    bool failed = false;
+
+    for (uint64_t c = 0; c < chunks; c++) {
+        auto *buffer = pool.take();
+
+        if (!failed && fwrite(buffer->data.data(), 1, buffer->data.size(), file) != buffer->data.size()) {
+            fprintf(stderr, "Failed to write %s, %s\n", out_path, strerror(errno));
+            failed = true;
+        }
+
+        written += buffer->samples;
+        bytes += buffer->data.size();
+        pool.release(buffer);
+    }
+
+    for (auto &worker : workers)
+        worker.join();
+
+    if (file != stdout)
+        fclose(file);
+    else
+        fflush(file);
+
+    if (failed)
+        return 1;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    fprintf(stderr, "%llu samples of %i joints, %.1f MB in %.2f s, %.2f M samples/s on %i threads\n",
+        (unsigned long long)written, joints, bytes / 1e6, seconds, written / seconds / 1e6, threads);
+
+    return 0;
+}
\ No newline at end of file